@@ -0,0 +1,96 @@
+#include "bench.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <roc/atomic_option.hpp>
+
+using namespace roc::import;
+
+namespace {
+    constexpr std::uint64_t operations_per_thread = 1000000;
+
+    // The hand-rolled version we are replacing: a magic value meaning "empty"
+    constexpr std::uint64_t SENTINEL = ~std::uint64_t{0};
+
+    template <typename Func>
+    void contended(unsigned threads, Func&& f)
+    {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+            workers.emplace_back([&f, t] { f(t); });
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    template <typename T, typename Policy = roc::boolopt<false>>
+    void bench_atomic_option(const char* type_name, unsigned threads)
+    {
+        using option_type = typename roc::atomic_option<T, Policy>::option_type;
+
+        roc::atomic_option<T, Policy> slot;
+        const std::string prefix = std::string("atomic_option<") + type_name + ">, "
+                                 + std::to_string(threads) + " threads, ";
+
+        roc::bench::run((prefix + "load").c_str(), operations_per_thread * threads, [&] {
+            contended(threads, [&](unsigned) {
+                for (std::uint64_t i = 0; i < operations_per_thread; ++i)
+                    roc::bench::do_not_optimize(slot.load(std::memory_order_acquire));
+            });
+        });
+
+        roc::bench::run((prefix + "store / take").c_str(), operations_per_thread * threads, [&] {
+            contended(threads, [&](unsigned t) {
+                for (std::uint64_t i = 0; i < operations_per_thread; ++i) {
+                    if ((i + t) & 1)
+                        slot.store(option_type{static_cast<T>(i)}, std::memory_order_release);
+                    else
+                        roc::bench::do_not_optimize(slot.take(std::memory_order_acq_rel));
+                }
+            });
+        });
+
+        roc::bench::run((prefix + "compare_exchange").c_str(), operations_per_thread * threads, [&] {
+            contended(threads, [&](unsigned) {
+                option_type expected = slot.load(std::memory_order_relaxed);
+                for (std::uint64_t i = 0; i < operations_per_thread; ++i)
+                    slot.compare_exchange_weak(expected, option_type{static_cast<T>(i)});
+            });
+        });
+    }
+
+    void bench_sentinel(unsigned threads)
+    {
+        std::atomic<std::uint64_t> slot {SENTINEL};
+        const std::string prefix = "atomic<uint64_t> + sentinel, " + std::to_string(threads) + " threads, ";
+
+        roc::bench::run((prefix + "store / take").c_str(), operations_per_thread * threads, [&] {
+            contended(threads, [&](unsigned t) {
+                for (std::uint64_t i = 0; i < operations_per_thread; ++i) {
+                    if ((i + t) & 1)
+                        slot.store(i, std::memory_order_release);
+                    else
+                        roc::bench::do_not_optimize(slot.exchange(SENTINEL, std::memory_order_acq_rel));
+                }
+            });
+        });
+    }
+}
+
+int main()
+{
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        bench_sentinel(threads);
+        bench_atomic_option<std::uint32_t>("uint32_t", threads);
+        bench_atomic_option<std::uint64_t, roc::sentinel_niche<std::uint64_t, SENTINEL>>("uint64_t, sentinel_niche", threads);
+#if defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+        bench_atomic_option<std::uint64_t>("uint64_t", threads);
+#endif
+    }
+
+    return 0;
+}
@@ -0,0 +1,254 @@
+#ifndef ROC_BENCH_HPP
+#define ROC_BENCH_HPP
+
+// Minimal benchmark helpers, the benchmarks are standalone programs:
+//     c++ -std=c++20 -O2 -Iinclude -pthread bench/<name>.cpp
+//
+// On Linux each repetition also reads hardware counters with
+// perf_event_open, user space only, so perf_event_paranoid up to 2 is
+// enough.  Where they can't be opened (containers, VMs without a PMU)
+// only the time is reported.  With ROC_BENCH_JSON=<file> set, the results
+// are also written there as JSON when the program exits, bench/compare.py
+// diffs two such files.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined (__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace roc::bench
+{
+    template <typename T>
+    inline void do_not_optimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    constexpr static std::size_t COUNTERS = 5;
+    constexpr static const char* COUNTER_NAMES[COUNTERS] = {
+        "instructions", "branches", "branch_misses", "l1d_misses", "l1i_misses"
+    };
+
+    struct measurement
+    {
+        std::string     name;
+        std::uint64_t   operations;
+        double          ns_per_op;          // fastest repetition
+        double          median_ns_per_op;
+
+        // per operation, from the fastest repetition, negative if unavailable
+        double          counters[COUNTERS];
+    };
+
+    namespace detail
+    {
+        // Each counter is opened on its own, so a PMU without L1i events still
+        // gives the rest.  inherit counts the threads a benchmark starts too.
+        // When there are more counters than the PMU has, the kernel
+        // multiplexes them, and each count is scaled up by the share of the
+        // time it was actually running.
+        class perf_counters
+        {
+            public:
+                perf_counters()
+                {
+                    #if defined (__linux__)
+                    if (std::getenv("ROC_BENCH_NO_PERF") != nullptr)
+                        return;
+
+                    constexpr std::uint64_t CACHE_READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                    const std::uint32_t types[COUNTERS] = {
+                        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+                    };
+                    const std::uint64_t configs[COUNTERS] = {
+                        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+                        PERF_COUNT_HW_CACHE_L1D | CACHE_READ_MISS, PERF_COUNT_HW_CACHE_L1I | CACHE_READ_MISS
+                    };
+
+                    for (std::size_t i = 0; i < COUNTERS; ++i) {
+                        perf_event_attr attr {};
+                        attr.size = sizeof(attr);
+                        attr.type = types[i];
+                        attr.config = configs[i];
+                        attr.disabled = 1;
+                        attr.inherit = 1;
+                        attr.exclude_kernel = 1;
+                        attr.exclude_hv = 1;
+                        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+                    }
+                    #endif
+                }
+
+                ~perf_counters()
+                {
+                    #if defined (__linux__)
+                    for (int fd : fds)
+                        if (fd >= 0)
+                            close(fd);
+                    #endif
+                }
+
+                perf_counters(const perf_counters&) = delete;
+                perf_counters& operator=(const perf_counters&) = delete;
+
+                bool any() const noexcept
+                {
+                    return std::any_of(std::begin(fds), std::end(fds), [](int fd) { return fd >= 0; });
+                }
+
+                void start() noexcept
+                {
+                    #if defined (__linux__)
+                    for (int fd : fds) {
+                        if (fd < 0)
+                            continue;
+                        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                    }
+                    #endif
+                }
+
+                // counts since start, -1 for the ones that aren't there or
+                // never got scheduled on the PMU
+                void stop(double (&counts)[COUNTERS]) noexcept
+                {
+                    for (std::size_t i = 0; i < COUNTERS; ++i) {
+                        counts[i] = -1.0;
+                        #if defined (__linux__)
+                        // laid out as read_format asks for
+                        struct { std::uint64_t value, enabled, running; } sample {};
+                        if (fds[i] >= 0) {
+                            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                            if (read(fds[i], &sample, sizeof(sample)) == sizeof(sample) && sample.running != 0)
+                                counts[i] = static_cast<double>(sample.value) * static_cast<double>(sample.enabled)
+                                          / static_cast<double>(sample.running);
+                        }
+                        #endif
+                    }
+                }
+
+            private:
+                int fds[COUNTERS] = {-1, -1, -1, -1, -1};
+        };
+
+        inline perf_counters& counters()
+        {
+            static perf_counters instance;
+            return instance;
+        }
+
+        inline void write_json_string(std::FILE* out, const std::string& text)
+        {
+            std::fputc('"', out);
+            for (char c : text) {
+                if (c == '"' || c == '\\')
+                    std::fputc('\\', out);
+                if (static_cast<unsigned char>(c) >= 0x20)
+                    std::fputc(c, out);
+            }
+            std::fputc('"', out);
+        }
+
+        // Collects every measurement, writes them out at exit
+        struct report
+        {
+            std::vector<measurement> results;
+
+            ~report()
+            {
+                const char* path = std::getenv("ROC_BENCH_JSON");
+                if (path == nullptr || results.empty())
+                    return;
+
+                std::FILE* out = std::fopen(path, "w");
+                if (out == nullptr) {
+                    std::fprintf(stderr, "can't write benchmark results to %s\n", path);
+                    return;
+                }
+
+                std::fprintf(out, "{\n  \"perf_counters\": %s,\n  \"benchmarks\": [", counters().any()? "true" : "false");
+                for (std::size_t i = 0; i < results.size(); ++i) {
+                    const measurement& m = results[i];
+                    std::fprintf(out, "%s\n    {\"name\": ", i == 0? "" : ",");
+                    write_json_string(out, m.name);
+                    std::fprintf(out, ", \"operations\": %llu, \"ns_per_op\": %.4f, \"median_ns_per_op\": %.4f",
+                                 static_cast<unsigned long long>(m.operations), m.ns_per_op, m.median_ns_per_op);
+                    for (std::size_t c = 0; c < COUNTERS; ++c)
+                        if (m.counters[c] >= 0.0)
+                            std::fprintf(out, ", \"%s\": %.4f", COUNTER_NAMES[c], m.counters[c]);
+                    std::fprintf(out, "}");
+                }
+                std::fprintf(out, "\n  ]\n}\n");
+                std::fclose(out);
+            }
+        };
+
+        inline report& global_report()
+        {
+            static report instance;
+            return instance;
+        }
+    }
+
+    // Runs f (which performs `operations` operations) a few times and reports
+    // the fastest run, the slower ones are mostly scheduling noise.  The
+    // median is kept as well, how far it is from the fastest run tells how
+    // noisy the benchmark is.
+    template <typename Func>
+    measurement run(const char* name, std::uint64_t operations, Func&& f, unsigned repetitions = 5)
+    {
+        using clock = std::chrono::steady_clock;
+        detail::perf_counters& counters = detail::counters();
+
+        std::vector<double> times;
+        double best_counts[COUNTERS];
+        std::fill(std::begin(best_counts), std::end(best_counts), -1.0);
+
+        for (unsigned i = 0; i < repetitions; ++i) {
+            double counts[COUNTERS];
+            counters.start();
+            const auto start = clock::now();
+            f();
+            const auto end = clock::now();
+            counters.stop(counts);
+
+            const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            if (times.empty() || ns < *std::min_element(times.begin(), times.end()))
+                std::copy(std::begin(counts), std::end(counts), std::begin(best_counts));
+            times.push_back(ns);
+        }
+
+        // no repetitions reports 0, like an empty run would
+        std::sort(times.begin(), times.end());
+        const double ops = static_cast<double>(operations);
+        const double fastest = times.empty()? 0.0 : times.front();
+        const double median = times.empty()? 0.0 : times[times.size() / 2];
+
+        measurement result { name, operations, fastest / ops, median / ops, {} };
+        for (std::size_t c = 0; c < COUNTERS; ++c)
+            result.counters[c] = best_counts[c] < 0.0? -1.0 : best_counts[c] / ops;
+
+        std::printf("%-60s %12.2f ns/op", result.name.c_str(), result.ns_per_op);
+        if (counters.any())
+            std::printf(" %10.1f ins %8.2f br-miss %8.2f L1d-miss %8.2f L1i-miss",
+                        result.counters[0], result.counters[2], result.counters[3], result.counters[4]);
+        std::printf("\n");
+
+        detail::global_report().results.push_back(result);
+        return result;
+    }
+}
+
+#endif
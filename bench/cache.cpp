@@ -0,0 +1,98 @@
+#include "bench.hpp"
+
+#include <cstdint>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <roc/cache.hpp>
+
+namespace {
+    constexpr std::size_t capacity = 1 << 16;
+    constexpr std::size_t count = 1000000;
+
+    // skewed keys, roughly 80% of the accesses hit 20% of a keyspace four
+    // times the cache capacity
+    std::vector<std::uint64_t> make_keys()
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<std::uint64_t> hot(0, capacity * 4 / 5);
+        std::uniform_int_distribution<std::uint64_t> cold(0, capacity * 4);
+        std::bernoulli_distribution pick_hot(0.8);
+
+        std::vector<std::uint64_t> keys(count);
+        for (auto& k : keys)
+            k = pick_hot(rng) ? hot(rng) : cold(rng);
+        return keys;
+    }
+
+    // the usual list + unordered_map LRU, for reference
+    class std_lru
+    {
+        public:
+            explicit std_lru(std::size_t capacity) : capacity(capacity) { index.reserve(capacity); }
+
+            std::uint64_t& get_or_load(std::uint64_t key)
+            {
+                auto found = index.find(key);
+                if (found != index.end()) {
+                    order.splice(order.begin(), order, found->second);
+                    return found->second->second;
+                }
+
+                if (index.size() == capacity) {
+                    index.erase(order.back().first);
+                    order.pop_back();
+                }
+                order.emplace_front(key, key * 3);
+                index.emplace(key, order.begin());
+                return order.front().second;
+            }
+
+        private:
+            using entry = std::pair<std::uint64_t, std::uint64_t>;
+            std::size_t capacity;
+            std::list<entry> order;
+            std::unordered_map<std::uint64_t, std::list<entry>::iterator> index;
+    };
+
+    template <typename Cache>
+    void run_cache(const char* name, const std::vector<std::uint64_t>& keys)
+    {
+        Cache cache(capacity);
+        roc::bench::run(name, count, [&] {
+            std::uint64_t sum = 0;
+            for (auto k : keys)
+                sum += cache.get_or_load(k, [k]() -> roc::result<std::uint64_t, int> {
+                    return roc::import::Ok(k * 3);
+                }).unwrap();
+            roc::bench::do_not_optimize(sum);
+        });
+
+        const auto& stats = cache.statistics();
+        std::printf("    hit rate %.1f%%, %llu evictions\n",
+                    100.0 * stats.hits / (stats.hits + stats.misses),
+                    static_cast<unsigned long long>(stats.evictions));
+    }
+}
+
+int main()
+{
+    const auto keys = make_keys();
+
+    run_cache<roc::lru_cache<std::uint64_t, std::uint64_t>>("lru_cache get_or_load (skewed)", keys);
+    run_cache<roc::clock_cache<std::uint64_t, std::uint64_t>>("clock_cache get_or_load (skewed)", keys);
+
+    {
+        std_lru cache(capacity);
+        roc::bench::run("std::list + unordered_map lru (skewed)", count, [&] {
+            std::uint64_t sum = 0;
+            for (auto k : keys)
+                sum += cache.get_or_load(k);
+            roc::bench::do_not_optimize(sum);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Compares two benchmark runs written with ROC_BENCH_JSON.
+
+    ROC_BENCH_JSON=before.json ./bench_queue
+    ... change something ...
+    ROC_BENCH_JSON=after.json ./bench_queue
+    bench/compare.py before.json after.json
+
+Both arguments can also be directories of such files, matched by file name.
+A change is only reported as faster or slower when it is bigger than the
+threshold and than the noise of both runs, the noise being how far the
+median repetition was from the fastest one.  Hardware counters are much
+steadier than time, so they have their own, smaller threshold.  Exits with
+1 if anything got slower, so it can gate a CI job.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+COUNTERS = ["instructions", "branches", "branch_misses", "l1d_misses", "l1i_misses"]
+
+
+def load(path):
+    files = [path]
+    if os.path.isdir(path):
+        files = sorted(os.path.join(path, name) for name in os.listdir(path) if name.endswith(".json"))
+
+    results = {}
+    for name in files:
+        with open(name) as f:
+            for bench in json.load(f)["benchmarks"]:
+                results[bench["name"]] = bench
+    return results
+
+
+def noise(bench):
+    fastest = bench["ns_per_op"]
+    return (bench["median_ns_per_op"] - fastest) / fastest if fastest > 0 else 0.0
+
+
+def change(before, after):
+    if before == 0:
+        return 0.0 if after == 0 else float("inf")
+    return (after - before) / before
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--time-threshold", type=float, default=0.05,
+                        help="relative ns/op change ignored as noise (default 0.05)")
+    parser.add_argument("--counter-threshold", type=float, default=0.02,
+                        help="relative counter change ignored as noise (default 0.02)")
+    args = parser.parse_args()
+
+    before = load(args.before)
+    after = load(args.after)
+    slower = 0
+
+    print(f"{'benchmark':<60} {'before':>10} {'after':>10} {'change':>8}")
+    for name in sorted(before.keys() & after.keys()):
+        old, new = before[name], after[name]
+        threshold = max(args.time_threshold, noise(old), noise(new))
+        delta = change(old["ns_per_op"], new["ns_per_op"])
+
+        verdict = ""
+        if delta > threshold:
+            verdict = "slower"
+            slower += 1
+        elif delta < -threshold:
+            verdict = "faster"
+        print(f"{name:<60} {old['ns_per_op']:>10.2f} {new['ns_per_op']:>10.2f} {delta:>+8.1%} {verdict}")
+
+        for counter in COUNTERS:
+            if counter not in old or counter not in new:
+                continue
+            delta = change(old[counter], new[counter])
+            if abs(delta) > args.counter_threshold:
+                print(f"    {counter:<56} {old[counter]:>10.2f} {new[counter]:>10.2f} {delta:>+8.1%}")
+
+    for name in sorted(before.keys() - after.keys()):
+        print(f"{name:<60} only in {args.before}")
+    for name in sorted(after.keys() - before.keys()):
+        print(f"{name:<60} only in {args.after}")
+
+    return 1 if slower else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
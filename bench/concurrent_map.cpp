@@ -0,0 +1,93 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <roc/concurrent_map.hpp>
+
+namespace {
+    constexpr std::uint64_t keys = 1 << 16;
+    constexpr std::uint64_t operations_per_thread = 500000;
+
+    // the shared cache we are replacing
+    class mutex_map
+    {
+        public:
+            roc::option<std::uint64_t> get(std::uint64_t key) const
+            {
+                std::lock_guard lock(mutex);
+                auto it = map.find(key);
+                if (it == map.end())
+                    return roc::none_type{};
+                return roc::option<std::uint64_t>{it->second};
+            }
+
+            void insert_or_assign(std::uint64_t key, std::uint64_t value)
+            {
+                std::lock_guard lock(mutex);
+                map.insert_or_assign(key, value);
+            }
+
+        private:
+            mutable std::mutex mutex;
+            std::unordered_map<std::uint64_t, std::uint64_t> map;
+    };
+
+    // read_percent of the operations are lookups, the rest writes
+    template <typename Map>
+    void mixed(const char* map_name, Map& map, unsigned threads, unsigned read_percent)
+    {
+        const std::string name = std::string(map_name) + ", " + std::to_string(read_percent) + "% reads, "
+                               + std::to_string(threads) + " threads";
+
+        roc::bench::run(name.c_str(), operations_per_thread * threads, [&] {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    std::mt19937_64 rng(t);
+                    std::uint64_t found = 0;
+                    for (std::uint64_t i = 0; i < operations_per_thread; ++i) {
+                        const std::uint64_t r = rng();
+                        const std::uint64_t key = r % keys;
+                        if ((r >> 32) % 100 < read_percent)
+                            found += map.get(key).is_some();
+                        else
+                            map.insert_or_assign(key, i);
+                    }
+                    roc::bench::do_not_optimize(found);
+                });
+            }
+            for (auto& w : workers)
+                w.join();
+        }, 3);
+    }
+}
+
+int main()
+{
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    roc::concurrent_map<std::uint64_t, std::uint64_t> sharded;
+    mutex_map single;
+    for (std::uint64_t k = 0; k < keys; k += 2) {
+        sharded.insert_or_assign(k, k);
+        single.insert_or_assign(k, k);
+    }
+
+    for (unsigned read_percent : {90u, 50u}) {
+        // doubling, and every core last even when that isn't a power of two
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, cores)) {
+            mixed("concurrent_map", sharded, threads, read_percent);
+            mixed("mutex + unordered_map", single, threads, read_percent);
+            if (threads == cores)
+                break;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include <roc/dyn_error.hpp>
+#include <roc/result.hpp>
+
+// Error path of a call that fails with one of a few error types, handled by
+// the caller checking for a base type.  The heap baseline is what
+// result<T, std::unique_ptr<base_error>> does: allocate the error, find the
+// type with dynamic_cast and free it.  roc::result only builds Err from
+// trivially movable errors, so the baseline carries the raw owning pointer.
+// Every allocation of the program is counted.
+
+namespace {
+    std::atomic<std::uint64_t> allocations {0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace {
+    constexpr std::size_t count = 1 << 20;
+
+    // type-erased errors
+    struct io_error
+    {
+        int code;
+    };
+
+    struct network_error : io_error
+    {
+        using base_error = io_error;
+        std::uint16_t port;
+    };
+
+    struct timeout_error : network_error
+    {
+        using base_error = network_error;
+        std::uint32_t milliseconds;
+    };
+
+    struct parse_error
+    {
+        const char* file;
+        int line;
+    };
+
+    // the same errors as a virtual hierarchy
+    struct base_error
+    {
+        virtual ~base_error() = default;
+    };
+
+    struct heap_io_error : base_error { int code = 0; };
+    struct heap_network_error : heap_io_error { std::uint16_t port = 0; };
+    struct heap_timeout_error : heap_network_error { std::uint32_t milliseconds = 0; };
+    struct heap_parse_error : base_error { const char* file = nullptr; int line = 0; };
+
+    [[gnu::noinline]] roc::result<int, roc::dyn_error> request_dyn(std::uint32_t kind)
+    {
+        switch (kind & 3) {
+            case 0: return roc::import::Ok(static_cast<int>(kind));
+            case 1: return roc::import::Err(timeout_error{{{110}, 443}, kind});
+            case 2: return roc::import::Err(network_error{{111}, 80});
+            default: return roc::import::Err(parse_error{"config.toml", static_cast<int>(kind)});
+        }
+    }
+
+    [[gnu::noinline]] roc::result<int, base_error*> request_heap(std::uint32_t kind)
+    {
+        switch (kind & 3) {
+            case 0: return roc::import::Ok(static_cast<int>(kind));
+            case 1: {
+                auto* error = new heap_timeout_error;
+                error->code = 110;
+                error->port = 443;
+                error->milliseconds = kind;
+                return roc::import::Err(static_cast<base_error*>(error));
+            }
+            case 2: {
+                auto* error = new heap_network_error;
+                error->code = 111;
+                error->port = 80;
+                return roc::import::Err(static_cast<base_error*>(error));
+            }
+            default: {
+                auto* error = new heap_parse_error;
+                error->line = static_cast<int>(kind);
+                return roc::import::Err(static_cast<base_error*>(error));
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::printf("sizeof(dyn_error) = %zu, sizeof(result<int, dyn_error>) = %zu\n",
+                sizeof(roc::dyn_error), sizeof(roc::result<int, roc::dyn_error>));
+
+    std::vector<std::uint32_t> kinds(count);
+    std::mt19937 random(42);
+    for (auto& k : kinds)
+        k = static_cast<std::uint32_t>(random());
+
+    // counted inside the loops, the harness allocates for its own bookkeeping
+    std::uint64_t dyn_allocations = 0;
+    std::uint64_t heap_allocations = 0;
+    std::uint64_t calls = 0;
+
+    roc::bench::run("result<int, dyn_error> error path", count, [&] {
+        const std::uint64_t before = allocations.load();
+        std::uint64_t sum = 0;
+        for (auto k : kinds) {
+            auto response = request_dyn(k);
+            if (response.is_ok())
+                sum += response.unwrap();
+            else if (auto network = response.err_value().downcast<network_error>(); network.is_some())
+                sum += network.unwrap().port;
+            else if (response.err_value().is<io_error>())
+                sum += 1;
+        }
+        roc::bench::do_not_optimize(sum);
+        dyn_allocations += allocations.load() - before;
+        calls += kinds.size();
+    });
+
+    roc::bench::run("result<int, base_error*> error path (heap, dynamic_cast)", count, [&] {
+        const std::uint64_t before = allocations.load();
+        std::uint64_t sum = 0;
+        for (auto k : kinds) {
+            auto response = request_heap(k);
+            if (response.is_ok()) {
+                sum += response.unwrap();
+                continue;
+            }
+            base_error* error = response.err_value();
+            if (auto* network = dynamic_cast<heap_network_error*>(error))
+                sum += network->port;
+            else if (dynamic_cast<heap_io_error*>(error) != nullptr)
+                sum += 1;
+            delete error;
+        }
+        roc::bench::do_not_optimize(sum);
+        heap_allocations += allocations.load() - before;
+    });
+
+    // the same calls ran in both loops
+    std::printf("allocations per call: dyn_error %.3f, heap %.3f\n",
+                static_cast<double>(dyn_allocations) / static_cast<double>(calls),
+                static_cast<double>(heap_allocations) / static_cast<double>(calls));
+    return dyn_allocations == 0? 0 : 1;
+}
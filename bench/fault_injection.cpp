@@ -0,0 +1,121 @@
+#define ROC_FAULT_INJECTION
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <roc/fault.hpp>
+
+// Drives a small request pipeline under load with faults injected at
+// increasing rates, to see what the error paths cost compared to the happy
+// path.  ROC_FAULT_SCHEDULE is ignored, the schedule is set per run.
+
+using namespace roc::import;
+
+namespace {
+    constexpr std::size_t requests_per_thread = 1 << 17;
+
+    enum class request_error : std::uint8_t { malformed = 1, not_found, unavailable };
+
+    struct request
+    {
+        std::uint32_t key;
+        std::uint32_t payload;
+    };
+
+    [[gnu::noinline]] roc::result<request, request_error> parse(std::uint32_t raw)
+    {
+        ROC_INJECT_FAULT(request_error::malformed);
+        return Ok(request{raw & 0xffff, raw >> 16});
+    }
+
+    [[gnu::noinline]] roc::result<std::uint64_t, request_error> lookup(const request& req)
+    {
+        ROC_INJECT_FAULT(request_error::not_found);
+        return Ok(std::uint64_t{req.key} * 0x9e3779b97f4a7c15ull);
+    }
+
+    [[gnu::noinline]] roc::result<std::uint64_t, request_error> store(std::uint64_t value)
+    {
+        ROC_INJECT_FAULT(request_error::unavailable);
+        return Ok(value ^ (value >> 29));
+    }
+
+    // errors are answered with a fallback, like a real handler would
+    std::uint64_t handle(std::uint32_t raw)
+    {
+        return parse(raw)
+            .and_then(lookup)
+            .and_then(store)
+            .or_else([raw](request_error e) {
+                return roc::result<std::uint64_t, request_error>{Ok(std::uint64_t{raw} + static_cast<std::uint64_t>(e))};
+            })
+            .unwrap();
+    }
+
+    struct latencies
+    {
+        std::vector<std::uint32_t> ok;
+        std::vector<std::uint32_t> failed;
+    };
+
+    double percentile(std::vector<std::uint32_t>& samples, double p)
+    {
+        if (samples.empty())
+            return 0.0;
+        const std::size_t index = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+}
+
+int main()
+{
+    using clock = std::chrono::steady_clock;
+    const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+
+    for (double rate : {0.0, 0.001, 0.01, 0.1, 0.5}) {
+        roc::fault::configure({.seed = 0x5eed, .rate = rate, .rules = {}});
+
+        char name[64];
+        std::snprintf(name, sizeof name, "%u threads, fault rate %.3f", threads, rate);
+        roc::bench::run(name, requests_per_thread * threads, [&] {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; ++t)
+                workers.emplace_back([t] {
+                    for (std::uint32_t i = 0; i < requests_per_thread; ++i)
+                        roc::bench::do_not_optimize(handle(i * 2654435761u + t));
+                });
+            for (auto& worker : workers)
+                worker.join();
+        });
+
+        // per request latency, split by whether a fault was injected
+        latencies samples;
+        for (std::uint32_t i = 0; i < requests_per_thread; ++i) {
+            const auto injected_before = roc::fault::sites();
+            std::uint64_t before = 0;
+            for (const auto& site : injected_before)
+                before += site.injected;
+
+            const auto start = clock::now();
+            roc::bench::do_not_optimize(handle(i * 2654435761u));
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+
+            std::uint64_t after = 0;
+            for (const auto& site : roc::fault::sites())
+                after += site.injected;
+            (after != before? samples.failed : samples.ok).push_back(static_cast<std::uint32_t>(ns));
+        }
+
+        std::printf("    ok:     %7zu requests, p50 %6.0f ns, p99 %6.0f ns\n",
+                    samples.ok.size(), percentile(samples.ok, 0.5), percentile(samples.ok, 0.99));
+        std::printf("    failed: %7zu requests, p50 %6.0f ns, p99 %6.0f ns\n",
+                    samples.failed.size(), percentile(samples.failed, 0.5), percentile(samples.failed, 0.99));
+    }
+}
@@ -0,0 +1,87 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <roc/flat_map.hpp>
+
+namespace {
+    constexpr std::size_t table_slots = 1 << 20;
+    constexpr std::size_t lookups = 1000000;
+
+    // what callers wrote before flat_map
+    template <typename Map, typename K>
+    roc::option<typename Map::mapped_type&> find_option(Map& map, const K& key)
+    {
+        auto it = map.find(key);
+        if (it == map.end())
+            return roc::none_type{};
+        return roc::option<typename Map::mapped_type&>{it->second};
+    }
+
+    // keys in [0, present) are in the table, the rest miss
+    std::vector<std::uint64_t> make_queries(std::mt19937_64& rng, std::size_t present, double hit_ratio)
+    {
+        std::vector<std::uint64_t> queries(lookups);
+        std::uniform_int_distribution<std::uint64_t> hit(0, present - 1);
+        std::uniform_int_distribution<std::uint64_t> miss(present, present * 4);
+        std::bernoulli_distribution is_hit(hit_ratio);
+        for (auto& q : queries)
+            q = is_hit(rng)? hit(rng) : miss(rng);
+        return queries;
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng(7);
+
+    for (double load : {0.25, 0.5, 0.75, 0.87}) {
+        const auto present = static_cast<std::size_t>(table_slots * load);
+
+        roc::flat_map<std::uint64_t, std::uint64_t> flat;
+        flat.reserve(present);
+        std::unordered_map<std::uint64_t, std::uint64_t> node;
+        node.reserve(present);
+
+        const std::string load_name = "load " + std::to_string(static_cast<int>(load * 100)) + "%";
+
+        roc::bench::run(("flat_map insert, " + load_name).c_str(), present, [&] {
+            flat.clear();
+            for (std::uint64_t k = 0; k < present; ++k)
+                (void)flat.try_emplace(k, k);
+        }, 3);
+        roc::bench::run(("unordered_map insert, " + load_name).c_str(), present, [&] {
+            node.clear();
+            for (std::uint64_t k = 0; k < present; ++k)
+                node.try_emplace(k, k);
+        }, 3);
+
+        for (double hit_ratio : {1.0, 0.5, 0.0}) {
+            const auto queries = make_queries(rng, present, hit_ratio);
+            const std::string name = load_name + ", " + std::to_string(static_cast<int>(hit_ratio * 100)) + "% hits";
+
+            roc::bench::run(("flat_map find, " + name).c_str(), lookups, [&] {
+                std::uint64_t sum = 0;
+                for (auto q : queries) {
+                    auto found = flat.find(q);
+                    sum += found.is_some()? found.unwrap() : 1;
+                }
+                roc::bench::do_not_optimize(sum);
+            });
+            roc::bench::run(("unordered_map find, " + name).c_str(), lookups, [&] {
+                std::uint64_t sum = 0;
+                for (auto q : queries) {
+                    auto found = find_option(node, q);
+                    sum += found.is_some()? found.unwrap() : 1;
+                }
+                roc::bench::do_not_optimize(sum);
+            });
+        }
+    }
+
+    return 0;
+}
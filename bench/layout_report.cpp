@@ -0,0 +1,280 @@
+// Layout and code size of option / result over a matrix of value and error
+// types, one line each:
+//     c++ -std=c++20 -O2 -Iinclude bench/layout_report.cpp && ./a.out
+//
+// payload is the largest alternative, flag the separate presence byte (0
+// when the state lives in a niche) and padding whatever is left of sizeof.
+// .text is the size of a function that destroys an object, constructs
+// either state in its place and checks it, read from the symbol table of the
+// program itself, so it depends on the compiler and flags the report was built
+// with.  Commit the output next to layout changes, tests/layout.cpp pins the
+// sizes the headers guarantee.
+
+#include <elf.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <roc/option.hpp>
+#include <roc/result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    enum class error_code : std::uint8_t { none, bad_input, too_big };
+
+    struct record
+    {
+        std::uint64_t   id;
+        std::uint8_t    kind;
+    };
+
+    struct alignas(16) vec4
+    {
+        float x, y, z, w;
+    };
+
+    // bytes an alternative takes in the storage union
+    template <typename T> struct alternative_size { constexpr static std::size_t value = sizeof(T); };
+    template <typename T> struct alternative_size<T&> { constexpr static std::size_t value = sizeof(T*); };
+    template <> struct alternative_size<void> { constexpr static std::size_t value = 0; };
+
+    template <typename R> struct payload;
+    template <typename T, typename P> struct payload<roc::option<T, P>>
+    {
+        constexpr static std::size_t value = alternative_size<T>::value;
+    };
+    template <typename T, typename E> struct payload<roc::result<T, E>>
+    {
+        constexpr static std::size_t value = std::max(alternative_size<T>::value, alternative_size<E>::value);
+    };
+
+    // something the optimiser can't see through to build values from
+    template <typename T>
+    [[gnu::noinline]] T opaque()
+    {
+        static std::remove_cvref_t<T> value {};
+        if constexpr (std::is_reference<T>::value || std::is_copy_constructible<T>::value)
+            return value;
+        else
+            return T{};
+    }
+
+    template <typename T, typename P>
+    [[gnu::noinline]] bool exercise(roc::option<T, P>* out, bool some)
+    {
+        using option_type = roc::option<T, P>;
+
+        out->~option_type();
+        if constexpr (std::is_void<T>::value) {
+            if (some)
+                new (out) option_type(Some());
+            else
+                new (out) option_type(None);
+        } else {
+            if (some)
+                new (out) option_type(opaque<T>());
+            else
+                new (out) option_type(None);
+        }
+
+        return out->is_some();
+    }
+
+    template <typename T, typename E>
+    [[gnu::noinline]] bool exercise(roc::result<T, E>* out, bool ok)
+    {
+        using result_type = roc::result<T, E>;
+
+        out->~result_type();
+        // results of types that aren't trivially movable can only be
+        // default constructed, one of the states is left out for those
+        if constexpr (std::is_void<T>::value) {
+            if (ok)
+                new (out) result_type(Ok());
+        } else if constexpr (requires { result_type(Ok(opaque<T>())); }) {
+            if (ok)
+                new (out) result_type(Ok(opaque<T>()));
+        }
+        if constexpr (requires { result_type(Err(opaque<E>())); }) {
+            if (not ok)
+                new (out) result_type(Err(opaque<E>()));
+        }
+
+        return out->is_ok();
+    }
+
+    struct elf_symbols
+    {
+        std::vector<char> bytes;
+
+        const Elf64_Ehdr& header() const { return *reinterpret_cast<const Elf64_Ehdr*>(bytes.data()); }
+        const Elf64_Shdr& section(std::size_t i) const {
+            return *reinterpret_cast<const Elf64_Shdr*>(bytes.data() + header().e_shoff + i * header().e_shentsize);
+        }
+
+        template <typename Func>
+        void each(Func&& f) const
+        {
+            if (bytes.size() < sizeof(Elf64_Ehdr))
+                return;
+            for (std::size_t i = 0; i < header().e_shnum; ++i) {
+                const Elf64_Shdr& s = section(i);
+                if (s.sh_type != SHT_SYMTAB)
+                    continue;
+                const char* names = bytes.data() + section(s.sh_link).sh_offset;
+                const auto* symbols = reinterpret_cast<const Elf64_Sym*>(bytes.data() + s.sh_offset);
+                for (std::size_t n = 0; n < s.sh_size / sizeof(Elf64_Sym); ++n)
+                    f(names + symbols[n].st_name, symbols[n]);
+            }
+        }
+
+        // size of the function at a run time address, 0 if the binary is stripped
+        std::uint64_t size_of(const void* function) const
+        {
+            const std::uint64_t address = reinterpret_cast<std::uintptr_t>(function) - load_bias();
+            std::uint64_t size = 0;
+            each([&](const char*, const Elf64_Sym& symbol) {
+                if (ELF64_ST_TYPE(symbol.st_info) == STT_FUNC && symbol.st_value == address)
+                    size = symbol.st_size;
+            });
+            return size;
+        }
+
+        // position independent executables are loaded somewhere else than
+        // they were linked to, anchor tells how far
+        std::uintptr_t load_bias() const;
+    };
+
+    elf_symbols load_self()
+    {
+        std::ifstream file("/proc/self/exe", std::ios::binary);
+        return elf_symbols{std::vector<char>(std::istreambuf_iterator<char>(file), {})};
+    }
+}
+
+extern "C" [[gnu::noinline, gnu::used]] void roc_layout_report_anchor() { asm volatile(""); }
+
+std::uintptr_t elf_symbols::load_bias() const
+{
+    std::uintptr_t linked = 0;
+    each([&](const char* name, const Elf64_Sym& symbol) {
+        if (std::string_view{name} == "roc_layout_report_anchor")
+            linked = symbol.st_value;
+    });
+    return reinterpret_cast<std::uintptr_t>(&roc_layout_report_anchor) - linked;
+}
+
+namespace {
+    const elf_symbols& self()
+    {
+        static const elf_symbols symbols = load_self();
+        return symbols;
+    }
+
+    const char* yes_no(bool value) { return value? "yes" : "no"; }
+
+    template <typename R>
+    void report(const char* name)
+    {
+        constexpr std::size_t PAYLOAD = payload<R>::value;
+        constexpr std::size_t FLAG = sizeof(R) > PAYLOAD? 1 : 0;
+        constexpr std::size_t PADDING = sizeof(R) - PAYLOAD - FLAG;
+
+        bool (*const function)(R*, bool) = &exercise;
+        const std::uint64_t text = self().size_of(reinterpret_cast<const void*>(function));
+
+        std::printf("%-48s %5zu %6zu %8zu %5zu %8zu %8s %8s %9s ",
+                    name, sizeof(R), alignof(R), PAYLOAD, FLAG, PADDING,
+                    yes_no(std::is_trivially_copyable<R>::value),
+                    yes_no(std::is_trivially_destructible<R>::value),
+                    yes_no(std::is_copy_constructible<R>::value));
+        if (text == 0)
+            std::printf("%6s\n", "-");
+        else
+            std::printf("%6llu\n", static_cast<unsigned long long>(text));
+    }
+}
+
+// the type names are printed as written, commas and all
+#define ROC_LAYOUT_ROW(...) report<__VA_ARGS__>(#__VA_ARGS__)
+
+int main()
+{
+    #if defined (__VERSION__)
+    std::printf("compiler %s", __VERSION__);
+    #endif
+    #if defined (__OPTIMIZE__)
+    std::printf(", optimised");
+    #endif
+    std::printf(", .text in bytes\n\n");
+
+    std::printf("%-48s %5s %6s %8s %5s %8s %8s %8s %9s %6s\n",
+                "type", "size", "align", "payload", "flag", "padding", "trv-copy", "trv-dtor", "copyable", ".text");
+
+    ROC_LAYOUT_ROW(roc::option<void>);
+    ROC_LAYOUT_ROW(roc::option<char>);
+    ROC_LAYOUT_ROW(roc::option<bool>);
+    ROC_LAYOUT_ROW(roc::option<bool, roc::no_niche>);
+    ROC_LAYOUT_ROW(roc::option<int>);
+    ROC_LAYOUT_ROW(roc::sentinel_option<std::uint32_t, UINT32_MAX>);
+    ROC_LAYOUT_ROW(roc::option<double>);
+    ROC_LAYOUT_ROW(roc::nan_option<double>);
+    ROC_LAYOUT_ROW(roc::option<int*>);
+    ROC_LAYOUT_ROW(roc::null_option<int*>);
+    ROC_LAYOUT_ROW(roc::option<int&>);
+    ROC_LAYOUT_ROW(roc::option<record>);
+    ROC_LAYOUT_ROW(roc::option<vec4>);
+    ROC_LAYOUT_ROW(roc::option<std::string_view>);
+    ROC_LAYOUT_ROW(roc::null_option<std::unique_ptr<int>>);
+    ROC_LAYOUT_ROW(roc::option<std::string>);
+    std::printf("\n");
+
+    ROC_LAYOUT_ROW(roc::result<void, error_code>);
+    ROC_LAYOUT_ROW(roc::result<bool, error_code>);
+    ROC_LAYOUT_ROW(roc::result<int, error_code>);
+    ROC_LAYOUT_ROW(roc::result<double, error_code>);
+    ROC_LAYOUT_ROW(roc::result<int&, error_code>);
+    ROC_LAYOUT_ROW(roc::result<record, error_code>);
+    ROC_LAYOUT_ROW(roc::result<vec4, error_code>);
+    ROC_LAYOUT_ROW(roc::result<std::string, error_code>);
+    std::printf("\n");
+
+    ROC_LAYOUT_ROW(roc::result<void, int>);
+    ROC_LAYOUT_ROW(roc::result<bool, int>);
+    ROC_LAYOUT_ROW(roc::result<int, int>);
+    ROC_LAYOUT_ROW(roc::result<double, int>);
+    ROC_LAYOUT_ROW(roc::result<int&, int>);
+    ROC_LAYOUT_ROW(roc::result<record, int>);
+    ROC_LAYOUT_ROW(roc::result<vec4, int>);
+    ROC_LAYOUT_ROW(roc::result<std::string, int>);
+    std::printf("\n");
+
+    ROC_LAYOUT_ROW(roc::result<void, std::error_code>);
+    ROC_LAYOUT_ROW(roc::result<bool, std::error_code>);
+    ROC_LAYOUT_ROW(roc::result<int, std::error_code>);
+    ROC_LAYOUT_ROW(roc::result<double, std::error_code>);
+    ROC_LAYOUT_ROW(roc::result<int&, std::error_code>);
+    ROC_LAYOUT_ROW(roc::result<record, std::error_code>);
+    ROC_LAYOUT_ROW(roc::result<vec4, std::error_code>);
+    ROC_LAYOUT_ROW(roc::result<std::string, std::error_code>);
+    std::printf("\n");
+
+    ROC_LAYOUT_ROW(roc::result<void, std::string>);
+    ROC_LAYOUT_ROW(roc::result<int, std::string>);
+    ROC_LAYOUT_ROW(roc::result<record, std::string>);
+    ROC_LAYOUT_ROW(roc::result<std::string, std::string>);
+
+    if (self().size_of(reinterpret_cast<const void*>(&roc_layout_report_anchor)) == 0)
+        std::printf("\nno symbol table, .text sizes need an unstripped binary\n");
+}
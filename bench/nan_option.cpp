@@ -0,0 +1,63 @@
+// The loops over nan_option only vectorise with -O3 (or -O2 -ftree-vectorize)
+
+#include "bench.hpp"
+
+#include <random>
+#include <vector>
+
+#include <roc/option.hpp>
+
+namespace {
+    constexpr std::size_t count = 1 << 20;
+
+    template <typename Option>
+    std::vector<Option> make_samples()
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> value(0.0, 100.0);
+        std::bernoulli_distribution missing(0.1);
+
+        std::vector<Option> samples(count);
+        for (auto& s : samples)
+            if (not missing(rng))
+                s = Option{value(rng)};
+        return samples;
+    }
+
+    template <typename Option>
+    void run_sum(const char* name)
+    {
+        const auto samples = make_samples<Option>();
+        roc::bench::run(name, count, [&] {
+            double sum = 0.0;
+            for (const auto& s : samples)
+                sum += s.unwrap_or(0.0);
+            roc::bench::do_not_optimize(sum);
+        });
+    }
+
+    template <typename Option>
+    void run_scale(const char* name)
+    {
+        auto samples = make_samples<Option>();
+        roc::bench::run(name, count, [&] {
+            for (auto& s : samples)
+                if (s.is_some())
+                    s.unwrap() *= 1.0001;
+            roc::bench::do_not_optimize(samples.data());
+        });
+    }
+}
+
+int main()
+{
+    std::printf("sizeof(option<double>) = %zu, sizeof(nan_option<double>) = %zu\n",
+                sizeof(roc::option<double>), sizeof(roc::nan_option<double>));
+
+    run_sum<roc::option<double>>("option<double> sum, 10% missing");
+    run_sum<roc::nan_option<double>>("nan_option<double> sum, 10% missing");
+    run_scale<roc::option<double>>("option<double> scale present, 10% missing");
+    run_scale<roc::nan_option<double>>("nan_option<double> scale present, 10% missing");
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <roc/ptr_result.hpp>
+
+namespace {
+    constexpr std::size_t count = 1 << 20;
+
+    enum class lookup_error : std::uint8_t { missing = 1 };
+
+    struct node
+    {
+        std::uint64_t key;
+        node* next;
+    };
+
+    // a hash table of short chains, the lookup result is returned through a
+    // non-inlined call like it would be across a library boundary
+    struct table
+    {
+        std::vector<node> nodes;
+        std::vector<node*> buckets;
+
+        table() : nodes(count), buckets(count / 4, nullptr)
+        {
+            for (std::size_t i = 0; i < count; ++i) {
+                node*& bucket = buckets[(i * 0x9e3779b97f4a7c15ull) >> 46 & (buckets.size() - 1)];
+                nodes[i] = node{i, bucket};
+                bucket = &nodes[i];
+            }
+        }
+
+        node* bucket_for(std::uint64_t key) const { return buckets[(key * 0x9e3779b97f4a7c15ull) >> 46 & (buckets.size() - 1)]; }
+
+        [[gnu::noinline]] roc::result<node*, lookup_error> find_result(std::uint64_t key) const
+        {
+            for (node* n = bucket_for(key); n != nullptr; n = n->next)
+                if (n->key == key)
+                    return roc::import::Ok(n);
+            return roc::import::Err(lookup_error::missing);
+        }
+
+        [[gnu::noinline]] roc::ptr_result<node, lookup_error> find_ptr_result(std::uint64_t key) const
+        {
+            for (node* n = bucket_for(key); n != nullptr; n = n->next)
+                if (n->key == key)
+                    return roc::import::Ok(n);
+            return roc::import::Err(lookup_error::missing);
+        }
+    };
+}
+
+int main()
+{
+    std::printf("sizeof(result<node*, E>) = %zu, sizeof(ptr_result<node, E>) = %zu\n",
+                sizeof(roc::result<node*, lookup_error>), sizeof(roc::ptr_result<node, lookup_error>));
+
+    table t;
+    std::vector<std::uint64_t> keys(count);
+    std::iota(keys.begin(), keys.end(), count / 2); // half of them miss
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(42));
+
+    roc::bench::run("result<node*, E> lookup", count, [&] {
+        std::uint64_t sum = 0;
+        for (auto k : keys) {
+            auto found = t.find_result(k);
+            sum += found.is_ok()? found.unwrap()->key : 1;
+        }
+        roc::bench::do_not_optimize(sum);
+    });
+
+    roc::bench::run("ptr_result<node, E> lookup", count, [&] {
+        std::uint64_t sum = 0;
+        for (auto k : keys) {
+            auto found = t.find_ptr_result(k);
+            sum += found.is_ok()? found.unwrap()->key : 1;
+        }
+        roc::bench::do_not_optimize(sum);
+    });
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "bench.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <roc/queue.hpp>
+
+namespace {
+    constexpr std::uint64_t items = 1000000;
+
+    void spin_wait() { std::this_thread::yield(); }
+
+    void spsc_throughput()
+    {
+        roc::spsc_queue<std::uint64_t, 1024> queue;
+
+        roc::bench::run("spsc_queue throughput, 1p / 1c", items, [&] {
+            std::thread consumer([&] {
+                for (std::uint64_t received = 0; received < items;) {
+                    auto v = queue.try_pop();
+                    if (v.is_some())
+                        received++;
+                    else
+                        spin_wait();
+                }
+            });
+            for (std::uint64_t i = 0; i < items; ++i)
+                while (queue.try_push(i).is_err())
+                    spin_wait();
+            consumer.join();
+        });
+    }
+
+    // round trip through a pair of queues, reported per one-way hop
+    void spsc_latency()
+    {
+        constexpr std::uint64_t round_trips = 100000;
+        roc::spsc_queue<std::uint64_t, 16> ping;
+        roc::spsc_queue<std::uint64_t, 16> pong;
+
+        roc::bench::run("spsc_queue latency, ping-pong hop", round_trips * 2, [&] {
+            std::thread echo([&] {
+                for (std::uint64_t i = 0; i < round_trips; ++i) {
+                    auto v = ping.try_pop();
+                    while (v.is_none()) {
+                        spin_wait();
+                        v = ping.try_pop();
+                    }
+                    while (pong.try_push(v.unwrap()).is_err())
+                        spin_wait();
+                }
+            });
+            for (std::uint64_t i = 0; i < round_trips; ++i) {
+                while (ping.try_push(i).is_err())
+                    spin_wait();
+                while (pong.try_pop().is_none())
+                    spin_wait();
+            }
+            echo.join();
+        }, 3);
+    }
+
+    void mpmc_throughput(unsigned producers, unsigned consumers)
+    {
+        roc::mpmc_queue<std::uint64_t> queue(1024);
+        const std::uint64_t per_producer = items / producers;
+        const std::uint64_t total = per_producer * producers;
+
+        const std::string name = "mpmc_queue throughput, " + std::to_string(producers) + "p / "
+                               + std::to_string(consumers) + "c";
+
+        roc::bench::run(name.c_str(), total, [&] {
+            std::atomic<std::uint64_t> received {0};
+            std::vector<std::thread> threads;
+
+            for (unsigned p = 0; p < producers; ++p) {
+                threads.emplace_back([&] {
+                    for (std::uint64_t i = 0; i < per_producer; ++i)
+                        while (queue.try_push(i).is_err())
+                            spin_wait();
+                });
+            }
+            for (unsigned c = 0; c < consumers; ++c) {
+                threads.emplace_back([&] {
+                    while (received.load(std::memory_order_relaxed) < total) {
+                        if (queue.try_pop().is_some())
+                            received.fetch_add(1, std::memory_order_relaxed);
+                        else
+                            spin_wait();
+                    }
+                });
+            }
+            for (auto& t : threads)
+                t.join();
+        }, 3);
+    }
+}
+
+int main()
+{
+    const unsigned cores = std::max(2u, std::thread::hardware_concurrency());
+
+    spsc_throughput();
+    spsc_latency();
+
+    for (unsigned n = 1; n <= cores / 2; n *= 2)
+        mpmc_throughput(n, n);
+    mpmc_throughput(1, cores - 1);
+    mpmc_throughput(cores - 1, 1);
+
+    return 0;
+}
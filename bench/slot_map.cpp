@@ -0,0 +1,118 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <roc/slot_map.hpp>
+
+namespace {
+    constexpr std::size_t count = 1000000;
+
+    struct particle {
+        float position[3];
+        float velocity[3];
+    };
+
+    particle make_particle(std::size_t i)
+    {
+        const float f = static_cast<float>(i);
+        return particle{{f, f, f}, {1.0f, 0.5f, 0.25f}};
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng(42);
+
+    // slot_map
+    {
+        roc::slot_map<particle> map;
+        std::vector<roc::slot_handle> handles;
+        handles.reserve(count);
+
+        roc::bench::run("slot_map insert", count, [&] {
+            map.clear();
+            handles.clear();
+            for (std::size_t i = 0; i < count; ++i)
+                handles.push_back(map.insert(make_particle(i)));
+        });
+
+        std::vector<roc::slot_handle> shuffled = handles;
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+        roc::bench::run("slot_map get (random)", count, [&] {
+            float sum = 0.0f;
+            for (auto h : shuffled)
+                sum += map.get(h).unwrap().position[0];
+            roc::bench::do_not_optimize(sum);
+        });
+
+        roc::bench::run("slot_map iterate", count, [&] {
+            for (auto& p : map)
+                for (int k = 0; k < 3; ++k)
+                    p.position[k] += p.velocity[k];
+            roc::bench::do_not_optimize(map.data());
+        });
+
+        roc::bench::run("slot_map erase + insert (churn)", count, [&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                auto& h = handles[i];
+                (void)map.erase(h);
+                h = map.insert(make_particle(i));
+            }
+        }, 3);
+
+        roc::bench::run("slot_map get (stale handle)", count, [&] {
+            std::size_t found = 0;
+            for (auto h : shuffled)
+                found += map.get(h).is_some();
+            roc::bench::do_not_optimize(found);
+        });
+    }
+
+    // std::unordered_map keyed by an incrementing id
+    {
+        std::unordered_map<std::uint64_t, particle> map;
+        std::vector<std::uint64_t> ids;
+        ids.reserve(count);
+        std::uint64_t next_id = 0;
+
+        roc::bench::run("unordered_map insert", count, [&] {
+            map.clear();
+            ids.clear();
+            for (std::size_t i = 0; i < count; ++i) {
+                map.emplace(next_id, make_particle(i));
+                ids.push_back(next_id++);
+            }
+        });
+
+        std::vector<std::uint64_t> shuffled = ids;
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+        roc::bench::run("unordered_map find (random)", count, [&] {
+            float sum = 0.0f;
+            for (auto id : shuffled)
+                sum += map.find(id)->second.position[0];
+            roc::bench::do_not_optimize(sum);
+        });
+
+        roc::bench::run("unordered_map iterate", count, [&] {
+            for (auto& [id, p] : map)
+                for (int k = 0; k < 3; ++k)
+                    p.position[k] += p.velocity[k];
+            roc::bench::do_not_optimize(map.size());
+        });
+
+        roc::bench::run("unordered_map erase + insert (churn)", count, [&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                map.erase(ids[i]);
+                map.emplace(next_id, make_particle(i));
+                ids[i] = next_id++;
+            }
+        }, 3);
+    }
+
+    return 0;
+}
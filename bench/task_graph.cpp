@@ -0,0 +1,74 @@
+#include "bench.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include <roc/task_graph.hpp>
+
+using namespace roc::import;
+
+namespace {
+    enum class bench_error { failed };
+
+    // one source fanning out to `width` tiny leaves
+    void wide_graph(roc::task_graph<bench_error>& graph, std::uint32_t width, std::atomic<std::uint64_t>& sink)
+    {
+        auto root = graph.emplace([]() -> roc::result<void, bench_error> { return Ok(); });
+        for (std::uint32_t i = 0; i < width; ++i) {
+            auto leaf = graph.emplace([&sink, i]() -> roc::result<void, bench_error> {
+                sink.fetch_add(i, std::memory_order_relaxed);
+                return Ok();
+            });
+            graph.precede(root, leaf);
+        }
+    }
+
+    // `width` independent chains of `depth` tasks passing an int along
+    void chains(roc::task_graph<bench_error>& graph, std::uint32_t width, std::uint32_t depth)
+    {
+        for (std::uint32_t i = 0; i < width; ++i) {
+            auto link = graph.emplace([i]() -> roc::result<int, bench_error> { return Ok(static_cast<int>(i)); });
+            for (std::uint32_t d = 1; d < depth; ++d)
+                link = graph.emplace([](int&& v) -> roc::result<int, bench_error> { return Ok(v + 1); }, link);
+        }
+    }
+}
+
+int main()
+{
+    constexpr std::uint32_t width = 100000;
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<std::uint64_t> sink {0};
+
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        roc::task_graph<bench_error> graph;
+        wide_graph(graph, width, sink);
+
+        std::string name = "wide graph, " + std::to_string(threads) + " threads";
+        roc::bench::run(name.c_str(), graph.size(), [&] { (void)graph.run(threads).is_ok(); });
+    }
+
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        roc::task_graph<bench_error> graph;
+        chains(graph, width / 16, 16);
+
+        std::string name = "chains 16 deep, " + std::to_string(threads) + " threads";
+        roc::bench::run(name.c_str(), graph.size(), [&] { (void)graph.run(threads).is_ok(); });
+    }
+
+    {
+        // a failing root cancels the whole fan-out without scheduling it
+        roc::task_graph<bench_error> graph;
+        auto root = graph.emplace([]() -> roc::result<void, bench_error> { return Err(bench_error::failed); });
+        for (std::uint32_t i = 0; i < width; ++i) {
+            auto leaf = graph.emplace([]() -> roc::result<void, bench_error> { return Ok(); });
+            graph.precede(root, leaf);
+        }
+        roc::bench::run("wide graph, failing root", graph.size(), [&] { (void)graph.run(cores).is_err(); });
+    }
+
+    roc::bench::do_not_optimize(sink);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "bench.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <roc/result.hpp>
+
+// Build it twice to compare, with and without -DROC_ENABLE_TELEMETRY
+
+using namespace roc::import;
+
+namespace {
+    constexpr std::size_t count = 1 << 22;
+
+    // a validation step that fails on every other input, not inlined so the
+    // Err is created like it would be in a separate function
+    [[gnu::noinline]] roc::result<std::uint32_t, int> validate(std::uint32_t value)
+    {
+        if (value & 1)
+            return Err(static_cast<int>(value));
+        return Ok(value);
+    }
+
+    [[gnu::noinline]] roc::result<std::uint32_t, int> always_fails(std::uint32_t value)
+    {
+        return Err(static_cast<int>(value));
+    }
+}
+
+int main()
+{
+    #if defined (ROC_ENABLE_TELEMETRY)
+    std::printf("telemetry enabled\n");
+    #else
+    std::printf("telemetry disabled\n");
+    #endif
+
+    roc::bench::run("Err on every call", count, [] {
+        for (std::uint32_t i = 0; i < count; ++i)
+            roc::bench::do_not_optimize(always_fails(i));
+    });
+
+    roc::bench::run("Err on every other call", count, [] {
+        for (std::uint32_t i = 0; i < count; ++i)
+            roc::bench::do_not_optimize(validate(i));
+    });
+
+    #if defined (ROC_ENABLE_TELEMETRY)
+    for (const auto& site : roc::telemetry::snapshot())
+        std::printf("%12llu  %s:%u  %s\n", static_cast<unsigned long long>(site.count),
+                    site.file, static_cast<unsigned>(site.line), site.function);
+    #endif
+}
@@ -0,0 +1,277 @@
+#ifndef ROC_ATOMIC_OPTION_HPP
+#define ROC_ATOMIC_OPTION_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "utility.hpp"
+#include "option.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+#if defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+        constexpr static bool HAS_DOUBLE_WIDTH_CAS = true;
+#else
+        constexpr static bool HAS_DOUBLE_WIDTH_CAS = false;
+#endif
+
+        template <std::size_t Size> struct atomic_option_word {};
+
+        template <>
+        struct atomic_option_word<8>
+        {
+            using type = std::uint64_t;
+
+            constexpr static bool is_always_lock_free = std::atomic<type>::is_always_lock_free;
+
+            type load(std::memory_order order) const noexcept { return word.load(order); }
+            void store(type desired, std::memory_order order) noexcept { word.store(desired, order); }
+            type exchange(type desired, std::memory_order order) noexcept { return word.exchange(desired, order); }
+
+            bool compare_exchange_strong(type& expected, type desired,
+                                         std::memory_order success, std::memory_order failure) noexcept {
+                return word.compare_exchange_strong(expected, desired, success, failure);
+            }
+            bool compare_exchange_weak(type& expected, type desired,
+                                       std::memory_order success, std::memory_order failure) noexcept {
+                return word.compare_exchange_weak(expected, desired, success, failure);
+            }
+
+            std::atomic<type> word {0};
+        };
+
+#if defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+        // std::atomic<unsigned __int128> goes through libatomic and doesn't claim
+        // to be lock-free, so we do the double-width CAS directly.  Every
+        // operation is a full barrier, the memory orders are accepted for
+        // interface compatibility only.
+        template <>
+        struct atomic_option_word<16>
+        {
+            using type = unsigned __int128;
+
+            // the macro is only defined when the CAS is a single instruction
+            constexpr static bool is_always_lock_free = true;
+
+            type load(std::memory_order) const noexcept {
+                return __sync_val_compare_and_swap(const_cast<type*>(&word), type{0}, type{0});
+            }
+            void store(type desired, std::memory_order order) noexcept { exchange(desired, order); }
+            type exchange(type desired, std::memory_order) noexcept {
+                // a guess, the first CAS fetches the real contents atomically
+                type current {0};
+                for (;;) {
+                    const type previous = __sync_val_compare_and_swap(&word, current, desired);
+                    if (previous == current)
+                        return previous;
+                    current = previous;
+                }
+            }
+
+            bool compare_exchange_strong(type& expected, type desired,
+                                         std::memory_order, std::memory_order) noexcept {
+                const type previous = __sync_val_compare_and_swap(&word, expected, desired);
+                if (previous == expected)
+                    return true;
+                expected = previous;
+                return false;
+            }
+            bool compare_exchange_weak(type& expected, type desired,
+                                       std::memory_order success, std::memory_order failure) noexcept {
+                return compare_exchange_strong(expected, desired, success, failure);
+            }
+
+            alignas(16) type word {0};
+        };
+#endif
+
+#if defined (__has_builtin)
+#if __has_builtin(__builtin_clear_padding)
+#define ROC_HAS_CLEAR_PADDING
+#endif
+#endif
+
+        // None is a value of T the niche gives, so it can be stored as is
+        template <typename Niche, typename T>
+        concept value_niche = requires (const T& value) { Niche::none(); Niche::is_none(value); };
+
+        // The value bytes go first, then zeroes, and flag in the last byte.
+        // Padding inside T is zeroed, the CAS compares whole words and stray
+        // padding bytes would make it fail on equal values.
+        template <std::size_t WordSize, typename T>
+        typename atomic_option_word<WordSize>::type pack_value(T value, unsigned char flag) noexcept
+        {
+#if not defined (ROC_HAS_CLEAR_PADDING)
+            static_assert(std::has_unique_object_representations<T>::value || std::is_scalar<T>::value,
+                          "without __builtin_clear_padding atomic_option can't hold types with padding");
+#else
+            __builtin_clear_padding(&value);
+#endif
+            unsigned char bytes[WordSize] = {};
+            std::memcpy(bytes, &value, sizeof(T));
+            if (flag != 0)
+                bytes[WordSize - 1] = flag;
+
+            typename atomic_option_word<WordSize>::type word;
+            std::memcpy(&word, bytes, WordSize);
+            return word;
+        }
+
+        template <typename T, typename Word>
+        T unpack_value(Word word) noexcept
+        {
+            T value;
+            std::memcpy(&value, &word, sizeof(T));
+            return value;
+        }
+
+        // Without a niche the presence flag takes the last byte of the word,
+        // so None is all zero bits and T has to leave that byte free
+        template <typename T, typename Policy, typename Niche = typename niche_for<T, Policy>::type>
+        struct atomic_option_codec
+        {
+            static_assert(sizeof(T) < 16, "atomic_option needs a spare byte for the presence flag, T must be smaller than 16 bytes");
+            static_assert(sizeof(T) < 8 || HAS_DOUBLE_WIDTH_CAS,
+                          "8-15 byte values need a double width CAS, compile with -mcx16 or use a niche policy");
+
+            using option_type = option<T, Policy>;
+
+            constexpr static std::size_t WORD_SIZE = sizeof(T) < 8 ? 8 : 16;
+            using word_type = typename atomic_option_word<WORD_SIZE>::type;
+
+            static word_type none() noexcept { return word_type{0}; }
+
+            static word_type encode(const option_type& opt) noexcept
+            {
+                return opt.is_none()? none() : pack_value<WORD_SIZE>(opt.unwrap(), 1);
+            }
+
+            static option_type decode(word_type word) noexcept
+            {
+                unsigned char bytes[WORD_SIZE];
+                std::memcpy(bytes, &word, WORD_SIZE);
+                if (bytes[WORD_SIZE - 1] == 0)
+                    return none_type{};
+                return option_type{unpack_value<T>(word)};
+            }
+        };
+
+        // With a niche (sentinel_niche, nan_niche, null_niche) the word is
+        // just the value, so an 8-byte T stays in a plain 8-byte atomic
+        template <typename T, typename Policy, typename Niche> requires value_niche<Niche, T>
+        struct atomic_option_codec<T, Policy, Niche>
+        {
+            static_assert(sizeof(T) <= 16, "atomic_option holds values up to 16 bytes");
+            static_assert(sizeof(T) <= 8 || HAS_DOUBLE_WIDTH_CAS,
+                          "9-16 byte values need a double width CAS, compile with -mcx16 or use a smaller type");
+
+            using option_type = option<T, Policy>;
+
+            constexpr static std::size_t WORD_SIZE = sizeof(T) <= 8 ? 8 : 16;
+            using word_type = typename atomic_option_word<WORD_SIZE>::type;
+
+            static word_type none() noexcept { return pack_value<WORD_SIZE>(Niche::none(), 0); }
+
+            static word_type encode(const option_type& opt) noexcept
+            {
+                return opt.is_none()? none() : pack_value<WORD_SIZE>(opt.unwrap(), 0);
+            }
+
+            static option_type decode(word_type word) noexcept
+            {
+                const T value = unpack_value<T>(word);
+                if (Niche::is_none(value))
+                    return none_type{};
+                return option_type{value};
+            }
+        };
+    }
+
+    // Lock-free option<T, Policy> for small trivially copyable T.
+    //
+    // With a niche policy (sentinel_niche, nan_niche, null_niche) the word is
+    // the value itself, so values up to 8 bytes, uint64_t, double or pointers
+    // included, use a plain 8-byte atomic.  Otherwise T and a presence byte
+    // are packed into the word, up to 7 byte values fit in 8 bytes.  Larger
+    // values use 16 bytes with a double width CAS (cmpxchg16b, needs -mcx16 on
+    // x86-64), where even a load is a CAS.  compare-exchange compares the
+    // bytes of the values with their padding zeroed, not with operator==, so
+    // for floats 0.0 and -0.0 differ and a NaN matches itself.
+    template <typename T, typename Policy = boolopt<false>>
+    class atomic_option
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "atomic_option requires trivially copyable type");
+        static_assert(std::is_default_constructible<T>::value, "atomic_option requires default constructible type");
+
+        using codec = detail::atomic_option_codec<T, Policy>;
+        using word_type = typename codec::word_type;
+        using word = detail::atomic_option_word<codec::WORD_SIZE>;
+
+        public:
+            using value_type = T;
+            using option_type = option<T, Policy>;
+
+            constexpr static bool is_always_lock_free = word::is_always_lock_free;
+
+            atomic_option() noexcept { storage.store(codec::none(), std::memory_order_relaxed); }
+            atomic_option(option_type initial) noexcept { storage.store(codec::encode(initial), std::memory_order_relaxed); }
+
+            atomic_option(const atomic_option&) = delete;
+            atomic_option& operator=(const atomic_option&) = delete;
+
+            option_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+                return codec::decode(storage.load(order));
+            }
+
+            void store(option_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+                storage.store(codec::encode(desired), order);
+            }
+
+            option_type exchange(option_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+                return codec::decode(storage.exchange(codec::encode(desired), order));
+            }
+
+            // Leaves None behind and returns what was there
+            option_type take(std::memory_order order = std::memory_order_seq_cst) noexcept {
+                return codec::decode(storage.exchange(codec::none(), order));
+            }
+
+            bool is_some(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+                return load(order).is_some();
+            }
+            bool is_none(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+                return load(order).is_none();
+            }
+
+            // On failure, expected is updated with the current contents
+            bool compare_exchange_strong(option_type& expected, option_type desired,
+                                         std::memory_order success = std::memory_order_seq_cst,
+                                         std::memory_order failure = std::memory_order_seq_cst) noexcept
+            {
+                word_type current = codec::encode(expected);
+                if (storage.compare_exchange_strong(current, codec::encode(desired), success, failure))
+                    return true;
+                expected = codec::decode(current);
+                return false;
+            }
+
+            bool compare_exchange_weak(option_type& expected, option_type desired,
+                                       std::memory_order success = std::memory_order_seq_cst,
+                                       std::memory_order failure = std::memory_order_seq_cst) noexcept
+            {
+                word_type current = codec::encode(expected);
+                if (storage.compare_exchange_weak(current, codec::encode(desired), success, failure))
+                    return true;
+                expected = codec::decode(current);
+                return false;
+            }
+
+        private:
+            word storage;
+    };
+}
+
+#endif
@@ -0,0 +1,441 @@
+#ifndef ROC_CACHE_HPP
+#define ROC_CACHE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+
+#if defined (ROC_ENABLE_EXCEPTIONS)
+#include <exception>
+namespace roc {
+    struct bad_cache_capacity : public std::exception
+    {
+        bad_cache_capacity() = default;
+        const char* what() const noexcept override { return "Cache capacity must be at least one entry"; }
+    };
+}
+#endif
+
+#include "utility.hpp"
+#include "option.hpp"
+#include "result.hpp"
+
+namespace roc
+{
+    struct cache_stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+    };
+
+    namespace detail
+    {
+        template <typename R, typename V> struct cache_loader_traits
+        {
+            static_assert(dependent_false<R>(), "loader must return roc::result<V, E>");
+        };
+
+        // loader produces the value, errors are passed through
+        template <typename V, typename E> struct cache_loader_traits<result<V, E>, V>
+        {
+            constexpr static bool CACHES_ERRORS = false;
+            using return_type = result<V&, E>;
+        };
+
+        // the cached type is the result itself, so errors are cached too
+        template <typename T, typename E> struct cache_loader_traits<result<T, E>, result<T, E>>
+        {
+            constexpr static bool CACHES_ERRORS = true;
+            using return_type = result<T, E>&;
+        };
+
+        // Fixed capacity table shared by the caches.  Every entry is allocated up
+        // front, the hash chains and the per-policy links (Links) are intrusive
+        // indices inside the entries, so nothing allocates after construction.
+        template <typename K, typename V, typename Links, typename Hash, typename Eq>
+        class cache_table
+        {
+            public:
+                constexpr static std::uint32_t NO_ENTRY = ~std::uint32_t{0};
+
+                struct entry
+                {
+                    entry() noexcept {}
+                    ~entry() {}
+
+                    union { K key; };
+                    union { V value; };
+                    std::uint32_t hash_next = NO_ENTRY;
+                    bool occupied = false;
+                    Links links;
+                };
+
+                // two buckets per entry keeps the chains short.  Inserting
+                // always needs an entry to put the value in, so capacity 0
+                // is rejected.
+                explicit cache_table(std::uint32_t capacity)
+                    : entry_count(checked_capacity(capacity)),
+                      bucket_mask(round_up(capacity) * 2 - 1),
+                      entries(new entry[capacity]),
+                      buckets(new std::uint32_t[bucket_mask + 1])
+                {
+                    for (std::uint32_t i = 0; i <= bucket_mask; ++i)
+                        buckets[i] = NO_ENTRY;
+
+                    // free list goes through hash_next
+                    for (std::uint32_t i = 0; i < capacity; ++i)
+                        entries[i].hash_next = i + 1 < capacity? i + 1 : NO_ENTRY;
+                    free_head = 0;
+                }
+
+                cache_table(const cache_table&) = delete;
+                cache_table& operator=(const cache_table&) = delete;
+
+                ~cache_table()
+                {
+                    for (std::uint32_t i = 0; i < entry_count; ++i)
+                        if (entries[i].occupied)
+                            destroy(entries[i]);
+                }
+
+                std::uint32_t find(const K& key) const noexcept
+                {
+                    for (std::uint32_t i = buckets[bucket_of(key)]; i != NO_ENTRY; i = entries[i].hash_next)
+                        if (Eq{}(entries[i].key, key))
+                            return i;
+                    return NO_ENTRY;
+                }
+
+                bool full() const noexcept { return free_head == NO_ENTRY; }
+
+                // Places the key and make() in a free entry, the table must not be
+                // full.  Taking a callable lets a prvalue be constructed in place.
+                // The entry only leaves the free list once both are constructed,
+                // so a throwing make() or key copy leaves the table as it was.
+                template <typename Make>
+                std::uint32_t emplace(const K& key, Make&& make)
+                {
+                    const std::uint32_t index = free_head;
+                    entry& e = entries[index];
+
+                    new (&e.value) V(std::invoke(::roc::forward<Make>(make)));
+                    value_guard guard { &e.value };
+                    new (&e.key) K(key);
+                    guard.value = nullptr;
+
+                    free_head = e.hash_next;
+                    e.occupied = true;
+
+                    std::uint32_t& bucket = buckets[bucket_of(key)];
+                    e.hash_next = bucket;
+                    bucket = index;
+
+                    count++;
+                    return index;
+                }
+
+                // Unlinks the entry and moves the value out
+                option<V> take(std::uint32_t index)
+                {
+                    option<V> taken{::roc::move(entries[index].value)};
+                    remove(index);
+                    return taken;
+                }
+
+                // Unlinks and destroys the entry
+                void remove(std::uint32_t index) noexcept
+                {
+                    entry& e = entries[index];
+
+                    std::uint32_t* link = &buckets[bucket_of(e.key)];
+                    while (*link != index)
+                        link = &entries[*link].hash_next;
+                    *link = e.hash_next;
+
+                    destroy(e);
+
+                    e.hash_next = free_head;
+                    free_head = index;
+                    count--;
+                }
+
+                entry& operator[](std::uint32_t index) noexcept { return entries[index]; }
+                const entry& operator[](std::uint32_t index) const noexcept { return entries[index]; }
+
+                std::uint32_t size() const noexcept { return count; }
+                std::uint32_t capacity() const noexcept { return entry_count; }
+
+            private:
+                // Destroys a value whose key couldn't be constructed
+                struct value_guard
+                {
+                    V* value;
+
+                    ~value_guard()
+                    {
+                        if (value != nullptr)
+                            value->~V();
+                    }
+                };
+
+                static std::uint32_t checked_capacity(std::uint32_t capacity)
+                {
+                    if (capacity == 0) THROW_OR_PANIC(bad_cache_capacity());
+                    return capacity;
+                }
+
+                static std::uint32_t round_up(std::uint32_t capacity) noexcept
+                {
+                    std::uint32_t size = 1;
+                    while (size < capacity)
+                        size <<= 1;
+                    return size;
+                }
+
+                std::uint32_t bucket_of(const K& key) const noexcept
+                {
+                    const std::size_t hash = Hash{}(key) * 0x9e3779b97f4a7c15ull;
+                    return static_cast<std::uint32_t>(hash >> 32) & bucket_mask;
+                }
+
+                static void destroy(entry& e) noexcept
+                {
+                    e.key.~K();
+                    e.value.~V();
+                    e.occupied = false;
+                }
+
+                const std::uint32_t entry_count;
+                const std::uint32_t bucket_mask;
+                std::unique_ptr<entry[]> entries;
+                std::unique_ptr<std::uint32_t[]> buckets;
+                std::uint32_t free_head = NO_ENTRY;
+                std::uint32_t count = 0;
+        };
+
+        // Shared interface, Policy provides touch / unlink / push / victim
+        template <typename Policy, typename K, typename V, typename Links, typename Hash, typename Eq>
+        class cache_base
+        {
+            protected:
+                using table_type = cache_table<K, V, Links, Hash, Eq>;
+                constexpr static std::uint32_t NO_ENTRY = table_type::NO_ENTRY;
+
+            public:
+                using key_type = K;
+                using mapped_type = V;
+
+                explicit cache_base(std::uint32_t capacity) : table(capacity) {}
+
+                option<V&> get(const K& key) noexcept
+                {
+                    const std::uint32_t index = table.find(key);
+                    if (index == NO_ENTRY) {
+                        stats.misses++;
+                        return none_type{};
+                    }
+
+                    stats.hits++;
+                    policy().touch(index);
+                    return option<V&>{table[index].value};
+                }
+
+                // Lookup without counting or touching the entry
+                option<const V&> peek(const K& key) const noexcept
+                {
+                    const std::uint32_t index = table.find(key);
+                    if (index == NO_ENTRY)
+                        return none_type{};
+                    return option<const V&>{table[index].value};
+                }
+
+                bool contains(const K& key) const noexcept { return table.find(key) != NO_ENTRY; }
+
+                template <typename U>
+                V& insert_or_assign(const K& key, U&& value)
+                {
+                    const std::uint32_t index = table.find(key);
+                    if (index != NO_ENTRY) {
+                        table[index].value = ::roc::forward<U>(value);
+                        policy().touch(index);
+                        return table[index].value;
+                    }
+                    return table[insert(key, [&]() -> V { return V(::roc::forward<U>(value)); })].value;
+                }
+
+                // On a miss, loader() -> result<V, E> is called and an Ok value is
+                // cached.  Err is passed through without caching anything, unless
+                // V is the loader's result type itself, in which case the whole
+                // result (Ok or Err) is cached and returned by reference.
+                template <typename Func,
+                          typename R = std::invoke_result_t<Func>,
+                          typename Traits = cache_loader_traits<R, V>>
+                typename Traits::return_type get_or_load(const K& key, Func&& loader)
+                {
+                    const std::uint32_t index = table.find(key);
+                    if (index != NO_ENTRY) {
+                        stats.hits++;
+                        policy().touch(index);
+                        if constexpr (Traits::CACHES_ERRORS)
+                            return table[index].value;
+                        else
+                            return import::Ok(table[index].value);
+                    }
+
+                    stats.misses++;
+                    if constexpr (Traits::CACHES_ERRORS) {
+                        return table[insert(key, ::roc::forward<Func>(loader))].value;
+                    } else {
+                        R loaded = std::invoke(::roc::forward<Func>(loader));
+                        if (loaded.is_err())
+                            return propagate(::roc::move(loaded));
+                        return import::Ok(table[insert(key, [&]() -> V { return ::roc::move(loaded).unwrap(); })].value);
+                    }
+                }
+
+                option<V> erase(const K& key)
+                {
+                    const std::uint32_t index = table.find(key);
+                    if (index == NO_ENTRY)
+                        return none_type{};
+
+                    policy().unlink(index);
+                    return table.take(index);
+                }
+
+                std::uint32_t size() const noexcept { return table.size(); }
+                std::uint32_t capacity() const noexcept { return table.capacity(); }
+
+                const cache_stats& statistics() const noexcept { return stats; }
+                void reset_statistics() noexcept { stats = cache_stats{}; }
+
+            protected:
+                template <typename Make>
+                std::uint32_t insert(const K& key, Make&& make)
+                {
+                    if (table.full()) {
+                        const std::uint32_t victim = policy().victim();
+                        policy().unlink(victim);
+                        table.remove(victim);
+                        stats.evictions++;
+                    }
+
+                    const std::uint32_t index = table.emplace(key, ::roc::forward<Make>(make));
+                    policy().push(index);
+                    return index;
+                }
+
+                Policy& policy() noexcept { return static_cast<Policy&>(*this); }
+
+                table_type table;
+                cache_stats stats;
+        };
+
+        struct lru_links
+        {
+            std::uint32_t prev;
+            std::uint32_t next;
+        };
+
+        struct clock_links
+        {
+            bool referenced;
+        };
+    }
+
+    // Least recently used cache with a fixed capacity.
+    //
+    // Entries are on an intrusive doubly linked list, most recently used first,
+    // and every hit moves the entry to the front.
+    template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+    class lru_cache : public detail::cache_base<lru_cache<K, V, Hash, Eq>, K, V, detail::lru_links, Hash, Eq>
+    {
+        using base = detail::cache_base<lru_cache, K, V, detail::lru_links, Hash, Eq>;
+        friend base;
+
+        public:
+            explicit lru_cache(std::uint32_t capacity) : base(capacity) {}
+
+        private:
+            using base::NO_ENTRY;
+
+            void touch(std::uint32_t index) noexcept
+            {
+                if (index == head)
+                    return;
+                unlink(index);
+                push(index);
+            }
+
+            void push(std::uint32_t index) noexcept
+            {
+                auto& links = this->table[index].links;
+                links.prev = NO_ENTRY;
+                links.next = head;
+                if (head != NO_ENTRY)
+                    this->table[head].links.prev = index;
+                head = index;
+                if (tail == NO_ENTRY)
+                    tail = index;
+            }
+
+            void unlink(std::uint32_t index) noexcept
+            {
+                auto& links = this->table[index].links;
+                if (links.prev != NO_ENTRY)
+                    this->table[links.prev].links.next = links.next;
+                else
+                    head = links.next;
+
+                if (links.next != NO_ENTRY)
+                    this->table[links.next].links.prev = links.prev;
+                else
+                    tail = links.prev;
+            }
+
+            std::uint32_t victim() const noexcept { return tail; }
+
+            std::uint32_t head = NO_ENTRY;
+            std::uint32_t tail = NO_ENTRY;
+    };
+
+    // CLOCK (second chance) cache, cheaper than LRU on hits.
+    //
+    // A hit only sets the referenced bit of the entry.  On eviction the hand
+    // sweeps over the entries, clearing referenced bits, and evicts the first
+    // entry that wasn't referenced since the last sweep.
+    template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+    class clock_cache : public detail::cache_base<clock_cache<K, V, Hash, Eq>, K, V, detail::clock_links, Hash, Eq>
+    {
+        using base = detail::cache_base<clock_cache, K, V, detail::clock_links, Hash, Eq>;
+        friend base;
+
+        public:
+            explicit clock_cache(std::uint32_t capacity) : base(capacity) {}
+
+        private:
+            void touch(std::uint32_t index) noexcept { this->table[index].links.referenced = true; }
+            void push(std::uint32_t index) noexcept { this->table[index].links.referenced = false; }
+            void unlink(std::uint32_t) noexcept {}
+
+            // only called when every entry is occupied
+            std::uint32_t victim() noexcept
+            {
+                for (;;) {
+                    auto& e = this->table[hand];
+                    const std::uint32_t current = hand;
+                    hand = hand + 1 == this->table.capacity()? 0 : hand + 1;
+
+                    if (not e.links.referenced)
+                        return current;
+                    e.links.referenced = false;
+                }
+            }
+
+            std::uint32_t hand = 0;
+    };
+}
+
+#endif
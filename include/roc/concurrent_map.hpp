@@ -0,0 +1,146 @@
+#ifndef ROC_CONCURRENT_MAP_HPP
+#define ROC_CONCURRENT_MAP_HPP
+
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+
+#include "utility.hpp"
+#include "option.hpp"
+#include "flat_map.hpp"
+
+namespace roc
+{
+    // Hash map shared between threads, split in lock-striped shards.
+    //
+    // Each shard is a flat_map behind its own reader-writer lock, on its own
+    // cache line, and the shard is picked from the top bits of the hash so it
+    // doesn't correlate with the slot inside the shard.  Lookups copy the value
+    // out, since a reference would outlive the lock.
+    template <typename K, typename V,
+              std::size_t Shards = 64,
+              typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+    class concurrent_map
+    {
+        static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0, "shard count must be a power of two");
+
+        public:
+            using key_type = K;
+            using mapped_type = V;
+
+            concurrent_map() = default;
+            concurrent_map(const concurrent_map&) = delete;
+            concurrent_map& operator=(const concurrent_map&) = delete;
+
+            option<V> get(const K& key) const
+            {
+                const shard& s = shard_for(key);
+                std::shared_lock lock(s.mutex);
+
+                auto found = s.map.find(key);
+                if (found.is_none())
+                    return none_type{};
+                return option<V>{found.unwrap()};
+            }
+
+            bool contains(const K& key) const
+            {
+                const shard& s = shard_for(key);
+                std::shared_lock lock(s.mutex);
+                return s.map.contains(key);
+            }
+
+            // Returns true if the key was inserted, false if it was overwritten
+            template <typename U>
+            bool insert_or_assign(const K& key, U&& value)
+            {
+                shard& s = shard_for(key);
+                std::unique_lock lock(s.mutex);
+
+                auto res = s.map.try_emplace(key, ::roc::forward<U>(value));
+                if (res.is_ok())
+                    return true;
+
+                res.err_value().get() = ::roc::forward<U>(value);
+                return false;
+            }
+
+            // Returns true if the key was inserted, the existing value is kept
+            template <typename... Args>
+            bool try_emplace(const K& key, Args&&... args)
+            {
+                shard& s = shard_for(key);
+                std::unique_lock lock(s.mutex);
+                return s.map.try_emplace(key, ::roc::forward<Args>(args)...).is_ok();
+            }
+
+            // Moves the value out, None if the key wasn't there
+            option<V> erase(const K& key)
+            {
+                shard& s = shard_for(key);
+                std::unique_lock lock(s.mutex);
+                return s.map.erase(key);
+            }
+
+            // Calls f(V&) under the shard lock if the key is present.  f should be
+            // short, it blocks every other key in the shard.
+            template <typename Func>
+            bool update(const K& key, Func&& f)
+            {
+                shard& s = shard_for(key);
+                std::unique_lock lock(s.mutex);
+
+                auto found = s.map.find(key);
+                if (found.is_none())
+                    return false;
+
+                std::invoke(::roc::forward<Func>(f), found.unwrap());
+                return true;
+            }
+
+            // Not a snapshot, shards are counted one at a time
+            std::size_t size() const
+            {
+                std::size_t total = 0;
+                for (const auto& s : shards) {
+                    std::shared_lock lock(s.mutex);
+                    total += s.map.size();
+                }
+                return total;
+            }
+
+            void clear()
+            {
+                for (auto& s : shards) {
+                    std::unique_lock lock(s.mutex);
+                    s.map.clear();
+                }
+            }
+
+            constexpr static std::size_t shard_count() noexcept { return Shards; }
+
+        private:
+            struct alignas(detail::CACHE_LINE_SIZE) shard
+            {
+                mutable std::shared_mutex mutex;
+                flat_map<K, V, Hash, Eq> map;
+            };
+
+            static std::size_t shard_index(const K& key) noexcept
+            {
+                if constexpr (Shards == 1)
+                    return 0;
+                else
+                    return detail::mix_hash(Hash{}(key) ^ 0x5bd1e995u) >> (sizeof(std::size_t) * 8 - SHARD_BITS);
+            }
+
+            shard& shard_for(const K& key) noexcept { return shards[shard_index(key)]; }
+            const shard& shard_for(const K& key) const noexcept { return shards[shard_index(key)]; }
+
+            constexpr static std::size_t SHARD_BITS = __builtin_ctzll(Shards);
+
+            shard shards[Shards];
+    };
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef ROC_DYN_ERROR_HPP
+#define ROC_DYN_ERROR_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#if defined (ROC_ENABLE_STD_STREAMS)
+#include <ostream>
+#endif
+
+#include "utility.hpp"
+#include "option.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+        // One object per type, its address is the id.  Inline variables are
+        // merged across translation units and shared libraries, as long as the
+        // error type isn't hidden in one of them.
+        template <typename E>
+        struct error_type_id
+        {
+            constexpr static char tag = 0;
+        };
+
+        template <typename E>
+        concept has_base_error = requires { typename E::base_error; };
+
+        template <typename E>
+        concept has_error_message = requires (const E& error) {
+            requires std::is_convertible<decltype(error.message()), const char*>::value;
+        };
+
+        struct error_ancestor
+        {
+            const void* id;
+            void*       (*upcast)(void*) noexcept;
+        };
+
+        template <typename E>
+        constexpr std::size_t error_depth()
+        {
+            if constexpr (has_base_error<E>)
+                return 1 + error_depth<typename E::base_error>();
+            else
+                return 1;
+        }
+
+        template <typename From, typename To>
+        void* upcast_error(void* error) noexcept
+        {
+            return static_cast<To*>(static_cast<From*>(error));
+        }
+
+        template <std::size_t N>
+        struct error_ancestors
+        {
+            error_ancestor entries[N];
+        };
+
+        // E first, then its base_error, the base_error of that...
+        template <typename E, typename Base = E, std::size_t N>
+        constexpr void fill_ancestors(error_ancestors<N>& list, std::size_t i)
+        {
+            list.entries[i] = error_ancestor{&error_type_id<Base>::tag, &upcast_error<E, Base>};
+            if constexpr (has_base_error<Base>) {
+                static_assert(std::is_base_of<typename Base::base_error, Base>::value,
+                              "base_error has to name a public base class of the error");
+                fill_ancestors<E, typename Base::base_error>(list, i + 1);
+            }
+        }
+
+        template <typename E>
+        const char* error_message(const void* error) noexcept
+        {
+            if constexpr (has_error_message<E>)
+                return static_cast<const E*>(error)->message();
+            else
+                return nullptr;
+        }
+
+        struct error_vtable
+        {
+            const error_ancestor*   ancestors;
+            std::size_t             depth;
+            const char*             (*message)(const void*) noexcept;
+        };
+
+        // Constant initialised, so there's one per error type in read-only
+        // data and nothing runs at startup
+        template <typename E>
+        struct error_vtable_for
+        {
+            constexpr static error_ancestors<error_depth<E>()> make_ancestors()
+            {
+                error_ancestors<error_depth<E>()> list {};
+                fill_ancestors<E>(list, 0);
+                return list;
+            }
+
+            constexpr static error_ancestors<error_depth<E>()> ANCESTORS = make_ancestors();
+            constexpr static error_vtable VTABLE = {ANCESTORS.entries, error_depth<E>(), &error_message<E>};
+        };
+    }
+
+    // Type-erased error stored inline, for results that cross module
+    // boundaries without a shared error enum.
+    //
+    // Holds any trivially copyable error of up to Size bytes, so it never
+    // allocates and copies as plain bytes, and result<T, dyn_error> is built
+    // from Err(any_error{...}) like any other result.  Errors form hierarchies
+    // by naming their parent in `using base_error = ...;`, is<E>() and
+    // downcast<E>() match E or any error that has it as an ancestor, without
+    // RTTI.  A `const char* message() const` on the error is picked up by
+    // message().
+    template <std::size_t Size, std::size_t Align = alignof(void*)>
+    class basic_dyn_error
+    {
+        public:
+            constexpr static std::size_t INLINE_SIZE = Size;
+
+            template <typename E>
+            constexpr static bool FITS = sizeof(E) <= Size && alignof(E) <= Align && std::is_trivially_copyable<E>::value;
+
+            basic_dyn_error() noexcept = default;
+
+            template <typename E> requires (not std::is_same<std::remove_cvref_t<E>, basic_dyn_error>::value)
+            basic_dyn_error(E&& error) noexcept(std::is_nothrow_constructible<std::remove_cvref_t<E>, E&&>::value)
+            {
+                using error_t = std::remove_cvref_t<E>;
+                static_assert(sizeof(error_t) <= Size && alignof(error_t) <= Align,
+                              "error doesn't fit in dyn_error, use a bigger basic_dyn_error");
+                static_assert(std::is_trivially_copyable<error_t>::value, "dyn_error stores trivially copyable errors");
+
+                ::new (static_cast<void*>(storage)) error_t(::roc::forward<E>(error));
+                table = &detail::error_vtable_for<error_t>::VTABLE;
+            }
+
+            // default constructed, no error stored
+            [[nodiscard]] bool is_empty() const noexcept { return table == nullptr; }
+
+            template <typename E>
+            [[nodiscard]] bool is() const noexcept { return find(&detail::error_type_id<std::remove_cv_t<E>>::tag) != nullptr; }
+
+            template <typename E>
+            option<E&> downcast() noexcept
+            {
+                if (table == &detail::error_vtable_for<std::remove_cv_t<E>>::VTABLE)
+                    return option<E&>{*std::launder(reinterpret_cast<E*>(storage))};
+                if (const detail::error_ancestor* match = find(&detail::error_type_id<std::remove_cv_t<E>>::tag))
+                    return option<E&>{*static_cast<E*>(match->upcast(storage))};
+                return none_type{};
+            }
+
+            template <typename E>
+            option<const E&> downcast() const noexcept
+            {
+                return const_cast<basic_dyn_error*>(this)->template downcast<const E>();
+            }
+
+            // message() of the stored error, nullptr if it has none
+            [[nodiscard]] const char* message() const noexcept { return table == nullptr? nullptr : table->message(storage); }
+
+        private:
+            // the exact type is the first entry, so a direct hit is one compare
+            const detail::error_ancestor* find(const void* id) const noexcept
+            {
+                if (table == nullptr)
+                    return nullptr;
+                for (std::size_t i = 0; i < table->depth; ++i)
+                    if (table->ancestors[i].id == id)
+                        return &table->ancestors[i];
+                return nullptr;
+            }
+
+            const detail::error_vtable* table = nullptr;
+            alignas(Align) unsigned char storage[Size];
+    };
+
+    // three words of payload, 32 bytes on 64-bit targets
+    using dyn_error = basic_dyn_error<3 * sizeof(void*)>;
+
+    #if defined (ROC_ENABLE_STD_STREAMS)
+    template <std::size_t Size, std::size_t Align>
+    std::ostream& operator<<(std::ostream& stream, const basic_dyn_error<Size, Align>& error) {
+        const char* message = error.message();
+        return stream << (message != nullptr? message : error.is_empty()? "no error" : "error");
+    }
+    #endif
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef ROC_ERROR_TRACE_HPP
+#define ROC_ERROR_TRACE_HPP
+
+// Error return traces, compiled in with ROC_ENABLE_ERROR_TRACE.
+//
+// Creating an Err starts a new trace, and every combinator that passes the
+// error on (and_then, map, map_err, or_else) and roc::propagate add the
+// address they were called from.  The result carries the id of its trace, so
+// an Err created while another one is being handled starts a trace of its
+// own and leaves the first one alone.  Only the error paths record anything,
+// and the traces are fixed ring buffers in thread local storage, so nothing
+// allocates.  Each thread keeps its TRACES newest traces, an error that
+// outlives that many newer ones, or moves to another thread, stops being
+// recorded.  Addresses are only symbolized when the trace is printed.  The
+// frames point into the calling functions when the combinators are inlined,
+// so traces from -O0 builds are less useful.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <ostream>
+
+#include "utility.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+        // Which trace an error belongs to, 0 for none
+        struct trace_handle
+        {
+            std::uint32_t id = 0;
+        };
+
+        struct trace_buffer
+        {
+            constexpr static std::size_t CAPACITY = 32;
+
+            void push(void* frame) noexcept { frames[total++ % CAPACITY] = frame; }
+
+            void*           frames[CAPACITY] = {};
+            std::uint32_t   total = 0;
+            std::uint32_t   id = 0;
+        };
+
+        constexpr static std::size_t TRACES = 8;
+
+        // ids are unique over all threads, so an error handled on another
+        // thread never matches a trace there
+        inline constinit std::atomic<std::uint32_t> next_trace_id {1};
+        inline constinit thread_local trace_buffer thread_traces[TRACES];
+        inline constinit thread_local std::uint32_t newest_trace = 0;
+
+        inline trace_buffer* find_trace(trace_handle trace) noexcept
+        {
+            trace_buffer& buffer = thread_traces[trace.id % TRACES];
+            return trace.id != 0 && buffer.id == trace.id? &buffer : nullptr;
+        }
+
+        // Out of line so the return address is in the function that created
+        // or passed on the error
+        [[gnu::noinline, gnu::cold]] inline trace_handle trace_begin() noexcept
+        {
+            std::uint32_t id = next_trace_id.fetch_add(1, std::memory_order_relaxed);
+            if (id == 0)
+                id = next_trace_id.fetch_add(1, std::memory_order_relaxed);
+
+            trace_buffer& buffer = thread_traces[id % TRACES];
+            buffer = trace_buffer{};
+            buffer.id = id;
+            buffer.push(__builtin_return_address(0));
+            newest_trace = id;
+            return trace_handle{id};
+        }
+
+        [[gnu::noinline, gnu::cold]] inline void trace_propagation(trace_handle trace) noexcept
+        {
+            if (trace_buffer* buffer = find_trace(trace))
+                buffer->push(__builtin_return_address(0));
+        }
+
+        // Base of result, the trace its error belongs to
+        struct trace_link
+        {
+            template <typename Wrapped>
+            constexpr void take_trace(const Wrapped& error) noexcept { trace = error.trace; }
+            constexpr trace_handle passed_trace() const noexcept { return trace; }
+
+            trace_handle trace {};
+        };
+    }
+
+    // Snapshot of one error's trace, the oldest kept frame first
+    class error_trace
+    {
+        public:
+            constexpr static std::size_t CAPACITY = detail::trace_buffer::CAPACITY;
+
+            constexpr error_trace() noexcept = default;
+
+            // The trace of the error in res, empty if it has been dropped
+            template <typename Result>
+            static error_trace of(const Result& res) noexcept
+            {
+                const detail::trace_buffer* buffer = detail::find_trace(res.passed_trace());
+                return buffer == nullptr? error_trace{} : error_trace{*buffer};
+            }
+
+            // The trace of the latest Err created on this thread
+            static error_trace current() noexcept
+            {
+                const detail::trace_buffer* buffer = detail::find_trace(detail::trace_handle{detail::newest_trace});
+                return buffer == nullptr? error_trace{} : error_trace{*buffer};
+            }
+
+            static void clear() noexcept
+            {
+                for (detail::trace_buffer& buffer : detail::thread_traces)
+                    buffer = detail::trace_buffer{};
+                detail::newest_trace = 0;
+            }
+
+            std::size_t size() const noexcept { return buffer.total < CAPACITY? buffer.total : CAPACITY; }
+            bool empty() const noexcept { return buffer.total == 0; }
+
+            // frames overwritten because the error went through more than CAPACITY
+            std::size_t dropped() const noexcept { return buffer.total - size(); }
+
+            void* operator[](std::size_t index) const noexcept
+            {
+                return buffer.frames[(buffer.total - size() + index) % CAPACITY];
+            }
+
+            // Symbolizes with dladdr, functions not in the dynamic symbol
+            // table print as module+offset for addr2line (or link with -rdynamic)
+            friend std::ostream& operator<<(std::ostream& stream, const error_trace& trace)
+            {
+                if (trace.dropped() != 0)
+                    stream << "  (" << trace.dropped() << " older frames dropped)\n";
+
+                for (std::size_t i = 0; i < trace.size(); ++i) {
+                    void* frame = trace[i];
+                    char address[2 + 2 * sizeof(void*) + 1];
+                    std::snprintf(address, sizeof address, "%p", frame);
+                    stream << "  #" << i << " " << address;
+
+                    Dl_info info {};
+                    if (dladdr(frame, &info) == 0 || info.dli_fname == nullptr) {
+                        stream << '\n';
+                        continue;
+                    }
+
+                    const auto at = reinterpret_cast<std::uintptr_t>(frame);
+                    if (info.dli_sname != nullptr) {
+                        int status = 0;
+                        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                        stream << " in " << (status == 0? demangled : info.dli_sname)
+                               << "+0x" << std::hex << (at - reinterpret_cast<std::uintptr_t>(info.dli_saddr)) << std::dec;
+                        std::free(demangled);
+                    }
+                    stream << " (" << info.dli_fname << "+0x" << std::hex
+                           << (at - reinterpret_cast<std::uintptr_t>(info.dli_fbase)) << std::dec << ")\n";
+                }
+                return stream;
+            }
+
+        private:
+            explicit error_trace(const detail::trace_buffer& snapshot) noexcept : buffer(snapshot) {}
+
+            detail::trace_buffer buffer;
+    };
+}
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef ROC_FAULT_HPP
+#define ROC_FAULT_HPP
+
+// Fault injection for functions returning result, compiled in with
+// ROC_FAULT_INJECTION.
+//
+//     roc::result<config, parse_error> load_config(const char* path)
+//     {
+//         ROC_INJECT_FAULT(parse_error::io);
+//         ...
+//     }
+//
+// Every ROC_INJECT_FAULT is its own site, which returns Err(args) at the
+// rate the schedule gives it.  Whether a call fails is a hash of the seed,
+// the site's file name and line and the number of earlier calls to the site
+// on the same thread, so the same schedule fails the same calls of each
+// thread every run, however the threads interleave and wherever the file is
+// built from.  Without ROC_FAULT_INJECTION the macro is empty and
+// nothing else here is compiled.
+
+#if defined (ROC_FAULT_INJECTION)
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utility.hpp"
+#include "result.hpp"
+
+namespace roc::fault
+{
+    // Site is either a function name or file:line, the file can be just the
+    // end of the path.  The last matching rule wins.
+    struct rule
+    {
+        std::string site;
+        double      rate;
+    };
+
+    struct schedule
+    {
+        std::uint64_t       seed = 0;
+        double              rate = 0.0;     // for sites without a rule
+        std::vector<rule>   rules;
+    };
+
+    struct site_stats
+    {
+        const char*     file;
+        unsigned        line;
+        const char*     function;
+        std::uint64_t   calls;
+        std::uint64_t   injected;
+    };
+
+    // "seed=42,rate=0.01,load_config=0.5,parser.cpp:120=1", Err holds the
+    // offset of the entry that didn't parse
+    inline result<schedule, std::size_t> parse_schedule(std::string_view text)
+    {
+        schedule parsed;
+        std::size_t offset = 0;
+
+        while (offset < text.size()) {
+            std::size_t end = text.find(',', offset);
+            if (end == std::string_view::npos)
+                end = text.size();
+
+            const std::string_view entry = text.substr(offset, end - offset);
+            const std::size_t equals = entry.rfind('=');
+            if (equals == std::string_view::npos || equals == 0)
+                return import::Err(offset + 0);
+
+            const std::string key(entry.substr(0, equals));
+            const std::string value(entry.substr(equals + 1));
+            char* parsed_end = nullptr;
+
+            if (key == "seed") {
+                parsed.seed = std::strtoull(value.c_str(), &parsed_end, 0);
+            } else {
+                const double rate = std::strtod(value.c_str(), &parsed_end);
+                if (not (rate >= 0.0 && rate <= 1.0))
+                    return import::Err(offset + 0);
+                if (key == "rate")
+                    parsed.rate = rate;
+                else
+                    parsed.rules.push_back({key, rate});
+            }
+            if (value.empty() || *parsed_end != '\0')
+                return import::Err(offset + 0);
+
+            offset = end + 1;
+        }
+        return import::Ok(::roc::move(parsed));
+    }
+
+    namespace detail
+    {
+        constexpr static const char* SCHEDULE_VARIABLE = "ROC_FAULT_SCHEDULE";
+
+        // rates are kept as 53-bit thresholds, the top 53 bits of the hash
+        // are compared against it, so a rate of 1 always fails
+        constexpr static std::uint64_t RATE_SCALE = std::uint64_t{1} << 53;
+
+        inline std::uint64_t mix(std::uint64_t x) noexcept
+        {
+            x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+            x ^= x >> 27; x *= 0x94d049bb133111ebull;
+            return x ^ (x >> 31);
+        }
+
+        // of the file name and line, not the pointers or the whole path, so
+        // it is the same in every run and however the compiler was given the
+        // file
+        inline std::uint64_t site_key(const char* file, unsigned line) noexcept
+        {
+            const char* name = file;
+            for (const char* c = file; *c != '\0'; ++c)
+                if (*c == '/' || *c == '\\')
+                    name = c + 1;
+
+            std::uint64_t hash = 0xcbf29ce484222325ull;
+            for (const char* c = name; *c != '\0'; ++c)
+                hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3ull;
+            return mix(hash ^ line);
+        }
+
+        inline bool matches(const rule& r, const char* file, unsigned line, const char* function)
+        {
+            const std::size_t colon = r.site.rfind(':');
+            if (colon == std::string::npos)
+                return r.site == function;
+
+            const std::string_view path = file;
+            const std::string_view wanted_file = std::string_view(r.site).substr(0, colon);
+            return r.site.substr(colon + 1) == std::to_string(line)
+                && path.size() >= wanted_file.size()
+                && path.substr(path.size() - wanted_file.size()) == wanted_file;
+        }
+
+        class site;
+
+        // Calls to a site from one thread since the last configure
+        struct thread_calls
+        {
+            std::uint32_t   generation = 0;
+            std::uint64_t   calls = 0;
+        };
+
+        struct registry
+        {
+            std::mutex                  lock;
+            schedule                    current;
+            std::vector<site*>          sites;
+            std::atomic<std::uint32_t>  generation {1};
+        };
+
+        inline registry& global_registry();
+
+        class site
+        {
+            public:
+                site(const char* file, unsigned line, const char* function)
+                    : file(file), line(line), function(function), key(site_key(file, line))
+                {
+                    registry& reg = global_registry();
+                    std::lock_guard guard(reg.lock);
+                    reg.sites.push_back(this);
+                    refresh(reg);
+                }
+
+                site(const site&) = delete;
+                site& operator=(const site&) = delete;
+
+                // own is the calling thread's count for this site, which is
+                // what decides the faults, calls counts every thread for stats
+                bool should_fail(thread_calls& own) noexcept
+                {
+                    registry& reg = global_registry();
+                    std::uint32_t generation = seen_generation.load(std::memory_order_acquire);
+                    if (generation != reg.generation.load(std::memory_order_acquire)) {
+                        std::lock_guard guard(reg.lock);
+                        refresh(reg);
+                        generation = seen_generation.load(std::memory_order_relaxed);
+                    }
+
+                    if (own.generation != generation) {
+                        own.generation = generation;
+                        own.calls = 0;
+                    }
+                    const std::uint64_t call = own.calls++;
+                    calls.fetch_add(1, std::memory_order_relaxed);
+
+                    const std::uint64_t limit = threshold.load(std::memory_order_relaxed);
+                    if (limit == 0)
+                        return false;
+
+                    if ((mix(seed.load(std::memory_order_relaxed) ^ key ^ mix(call)) >> 11) >= limit)
+                        return false;
+
+                    injected.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+
+                site_stats stats() const noexcept
+                {
+                    return { file, line, function, calls.load(std::memory_order_relaxed), injected.load(std::memory_order_relaxed) };
+                }
+
+                // called with the registry locked
+                void refresh(const registry& reg) noexcept
+                {
+                    double rate = reg.current.rate;
+                    for (const rule& r : reg.current.rules)
+                        if (matches(r, file, line, function))
+                            rate = r.rate;
+
+                    seed.store(mix(reg.current.seed), std::memory_order_relaxed);
+                    threshold.store(static_cast<std::uint64_t>(rate * static_cast<double>(RATE_SCALE)), std::memory_order_relaxed);
+                    seen_generation.store(reg.generation.load(std::memory_order_relaxed), std::memory_order_release);
+                }
+
+                void reset_counts() noexcept
+                {
+                    calls.store(0, std::memory_order_relaxed);
+                    injected.store(0, std::memory_order_relaxed);
+                }
+
+            private:
+                const char*                 file;
+                unsigned                    line;
+                const char*                 function;
+                std::uint64_t               key;
+                std::atomic<std::uint64_t>  seed {0};
+                std::atomic<std::uint64_t>  threshold {0};
+                std::atomic<std::uint64_t>  calls {0};
+                std::atomic<std::uint64_t>  injected {0};
+                std::atomic<std::uint32_t>  seen_generation {0};
+        };
+
+        inline void apply(registry& reg, schedule next)
+        {
+            std::lock_guard guard(reg.lock);
+            reg.current = ::roc::move(next);
+            reg.generation.fetch_add(1, std::memory_order_acq_rel);
+            for (site* s : reg.sites) {
+                s->reset_counts();
+                s->refresh(reg);
+            }
+        }
+
+        // never destroyed, sites are function statics that may outlive it
+        inline registry& global_registry()
+        {
+            static registry* instance = [] {
+                registry* reg = new registry;
+                if (const char* text = std::getenv(SCHEDULE_VARIABLE)) {
+                    auto parsed = parse_schedule(text);
+                    if (parsed.is_ok())
+                        reg->current = ::roc::move(parsed).unwrap();
+                }
+                return reg;
+            }();
+            return *instance;
+        }
+    }
+
+    // Replaces the schedule and restarts the call counts of every site, so
+    // the same schedule gives the same faults again
+    inline void configure(schedule next)
+    {
+        detail::apply(detail::global_registry(), ::roc::move(next));
+    }
+
+    // Reads the schedule from ROC_FAULT_SCHEDULE, which is also read at
+    // startup.  An unset variable means no faults, Err holds the offset of
+    // the entry that didn't parse and leaves the schedule as it was.
+    inline result<void, std::size_t> configure_from_environment()
+    {
+        const char* text = std::getenv(detail::SCHEDULE_VARIABLE);
+        if (text == nullptr) {
+            configure(schedule{});
+            return import::Ok();
+        }
+
+        auto parsed = parse_schedule(text);
+        if (parsed.is_err())
+            return propagate(::roc::move(parsed));
+        configure(::roc::move(parsed).unwrap());
+        return import::Ok();
+    }
+
+    // Every site reached so far, with the calls since the last configure
+    inline std::vector<site_stats> sites()
+    {
+        detail::registry& reg = detail::global_registry();
+        std::lock_guard guard(reg.lock);
+
+        std::vector<site_stats> stats;
+        for (const detail::site* s : reg.sites)
+            stats.push_back(s->stats());
+        return stats;
+    }
+}
+
+#define ROC_INJECT_FAULT(...)                                                                       \
+    do {                                                                                            \
+        static ::roc::fault::detail::site roc_fault_site {__FILE__, __LINE__, __func__};           \
+        static thread_local ::roc::fault::detail::thread_calls roc_fault_calls;                     \
+        if (roc_fault_site.should_fail(roc_fault_calls)) [[unlikely]]                               \
+            return ::roc::import::Err(__VA_ARGS__);                                                 \
+    } while (0)
+
+#else
+# define ROC_INJECT_FAULT(...) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,445 @@
+#ifndef ROC_FLAT_MAP_HPP
+#define ROC_FLAT_MAP_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "utility.hpp"
+#include "option.hpp"
+#include "result.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+        // Control byte of a flat_map slot: high bit set means the slot holds
+        // no value, otherwise the low 7 bits are the h2 part of the hash.
+        enum control_byte : std::int8_t
+        {
+            CONTROL_EMPTY   = -128, // 0b10000000
+            CONTROL_DELETED = -2,   // 0b11111110
+        };
+
+        constexpr static bool USE_SSE2 = true;
+
+#if defined (__SSE2__)
+        constexpr static bool HAS_SSE2 = true;
+#else
+        constexpr static bool HAS_SSE2 = false;
+#endif
+
+        // 16 control bytes matched at once, each query returns a bitmask with
+        // bit i set for matching byte i.
+        template <bool Simd = HAS_SSE2>
+        struct control_group
+        {
+            constexpr static std::size_t WIDTH = 16;
+
+            explicit control_group(const std::int8_t* ctrl) noexcept {
+                for (std::size_t i = 0; i < WIDTH; ++i)
+                    bytes[i] = ctrl[i];
+            }
+
+            std::uint32_t match(std::int8_t h2) const noexcept {
+                std::uint32_t mask = 0;
+                for (std::size_t i = 0; i < WIDTH; ++i)
+                    mask |= std::uint32_t{bytes[i] == h2} << i;
+                return mask;
+            }
+
+            std::uint32_t match_empty() const noexcept { return match(CONTROL_EMPTY); }
+
+            std::uint32_t match_empty_or_deleted() const noexcept {
+                std::uint32_t mask = 0;
+                for (std::size_t i = 0; i < WIDTH; ++i)
+                    mask |= std::uint32_t{bytes[i] < 0} << i;
+                return mask;
+            }
+
+            std::int8_t bytes[WIDTH];
+        };
+
+#if defined (__SSE2__)
+        template <>
+        struct control_group<USE_SSE2>
+        {
+            constexpr static std::size_t WIDTH = 16;
+
+            explicit control_group(const std::int8_t* ctrl) noexcept
+                : bytes(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+            std::uint32_t match(std::int8_t h2) const noexcept {
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes)));
+            }
+
+            std::uint32_t match_empty() const noexcept { return match(CONTROL_EMPTY); }
+
+            // full slots have the sign bit clear
+            std::uint32_t match_empty_or_deleted() const noexcept {
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(bytes));
+            }
+
+            __m128i bytes;
+        };
+#endif
+
+        inline std::uint32_t lowest_bit_index(std::uint32_t mask) noexcept { return __builtin_ctz(mask); }
+
+        // std::hash is the identity for integers, spread it before splitting
+        // into h1 (group) and h2 (control byte)
+#if defined (__SIZEOF_INT128__)
+        inline std::size_t mix_hash(std::size_t hash) noexcept
+        {
+            const unsigned __int128 product = static_cast<unsigned __int128>(hash) * 0x9e3779b97f4a7c15ull;
+            return static_cast<std::size_t>(product) ^ static_cast<std::size_t>(product >> 64);
+        }
+#else
+        // 32-bit targets have no 128 bit multiply, fold a 64 bit product
+        inline std::size_t mix_hash(std::size_t hash) noexcept
+        {
+            const std::uint64_t product = static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ull;
+            return static_cast<std::size_t>(product ^ (product >> 32));
+        }
+#endif
+    }
+
+    // Open-addressing hash map with Swiss table style control bytes.
+    //
+    // Slots are split in groups of 16, and a lookup compares the 7 bit hash
+    // fragment against a whole group with one SSE2 compare (or a scalar loop
+    // when SSE2 isn't available), touching the slot only on a fragment match.
+    // Groups are probed quadratically, and a lookup stops at the first group
+    // with an empty slot.
+    //
+    // find returns option<V&> and never allocates.  Any insertion can rehash,
+    // which invalidates references and iterators.
+    template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+    class flat_map
+    {
+        static_assert(not std::is_reference<K>::value && not std::is_reference<V>::value,
+                      "flat_map cannot hold references");
+
+        using group = detail::control_group<>;
+        constexpr static std::size_t GROUP_WIDTH = group::WIDTH;
+
+        struct slot_type
+        {
+            // the value is built in place, if it throws the key is destroyed
+            template <typename... Args>
+            explicit slot_type(const K& k, Args&&... args) : key(k), value(::roc::forward<Args>(args)...) {}
+
+            K key;
+            V value;
+        };
+
+        public:
+            using key_type = K;
+            using mapped_type = V;
+            using size_type = std::size_t;
+
+            template <bool Const>
+            class basic_iterator
+            {
+                using map_type = std::conditional_t<Const, const flat_map, flat_map>;
+                using value_ref = std::conditional_t<Const, const V&, V&>;
+
+                public:
+                    using reference = std::pair<const K&, value_ref>;
+
+                    basic_iterator(map_type* m, std::size_t i) noexcept : map(m), index(i) { skip_free(); }
+
+                    reference operator*() const noexcept {
+                        auto& slot = map->slots[index];
+                        return reference{slot.key, slot.value};
+                    }
+
+                    basic_iterator& operator++() noexcept { ++index; skip_free(); return *this; }
+                    bool operator==(const basic_iterator& rhs) const noexcept { return index == rhs.index; }
+
+                private:
+                    void skip_free() noexcept {
+                        while (index < map->slot_count && map->ctrl[index] < 0)
+                            ++index;
+                    }
+
+                    map_type* map;
+                    std::size_t index;
+            };
+
+            using iterator = basic_iterator<false>;
+            using const_iterator = basic_iterator<true>;
+
+            flat_map() noexcept = default;
+
+            explicit flat_map(size_type expected) { reserve(expected); }
+
+            flat_map(const flat_map&) = delete;
+            flat_map& operator=(const flat_map&) = delete;
+
+            flat_map(flat_map&& rhs) noexcept { swap(rhs); }
+            flat_map& operator=(flat_map&& rhs) noexcept { flat_map tmp(::roc::move(rhs)); swap(tmp); return *this; }
+
+            ~flat_map() { destroy(); }
+
+            option<V&> find(const K& key) noexcept
+            {
+                const std::size_t index = find_index(key);
+                if (index == NOT_FOUND)
+                    return none_type{};
+                return option<V&>{slots[index].value};
+            }
+
+            option<const V&> find(const K& key) const noexcept
+            {
+                const std::size_t index = find_index(key);
+                if (index == NOT_FOUND)
+                    return none_type{};
+                return option<const V&>{slots[index].value};
+            }
+
+            bool contains(const K& key) const noexcept { return find_index(key) != NOT_FOUND; }
+
+            // Ok(value) when the value was inserted, Err(existing) when the key
+            // was already present (args are left untouched in that case)
+            template <typename... Args>
+            result<V&, std::reference_wrapper<V>> try_emplace(const K& key, Args&&... args)
+            {
+                const std::size_t hash = hash_of(key);
+                const std::size_t existing = find_index(key, hash);
+                if (existing != NOT_FOUND)
+                    return import::Err(std::ref(slots[existing].value));
+
+                // the slot is only claimed once the value is constructed, so
+                // a throwing constructor leaves the map as it was
+                const std::size_t index = prepare_insert(hash);
+                new (&slots[index]) slot_type(key, ::roc::forward<Args>(args)...);
+                claim(index, hash);
+                return import::Ok(slots[index].value);
+            }
+
+            template <typename U>
+            V& insert_or_assign(const K& key, U&& value)
+            {
+                auto res = try_emplace(key, ::roc::forward<U>(value));
+                if (res.is_ok())
+                    return res.unwrap();
+
+                V& existing = res.err_value();
+                existing = ::roc::forward<U>(value);
+                return existing;
+            }
+
+            // Moves the value out, None if the key wasn't there
+            option<V> erase(const K& key)
+            {
+                const std::size_t index = find_index(key);
+                if (index == NOT_FOUND)
+                    return none_type{};
+
+                option<V> erased{::roc::move(slots[index].value)};
+                slots[index].~slot_type();
+
+                // If the group still has an empty slot, no probe sequence ever
+                // continued past it, and the slot can be marked empty again
+                const std::size_t group_start = index & ~(GROUP_WIDTH - 1);
+                if (group(ctrl + group_start).match_empty() != 0) {
+                    ctrl[index] = detail::CONTROL_EMPTY;
+                    growth_left++;
+                } else {
+                    ctrl[index] = detail::CONTROL_DELETED;
+                }
+                count--;
+
+                return erased;
+            }
+
+            void clear() noexcept
+            {
+                destroy_values();
+                for (std::size_t i = 0; i < slot_count; ++i)
+                    ctrl[i] = detail::CONTROL_EMPTY;
+                count = 0;
+                growth_left = max_load(slot_count);
+            }
+
+            void reserve(size_type expected)
+            {
+                std::size_t wanted = GROUP_WIDTH;
+                while (max_load(wanted) < expected)
+                    wanted <<= 1;
+                if (wanted > slot_count)
+                    rehash(wanted);
+            }
+
+            size_type size() const noexcept { return count; }
+            bool empty() const noexcept { return count == 0; }
+            size_type capacity() const noexcept { return slot_count; }
+            float load_factor() const noexcept { return slot_count? float(count) / float(slot_count) : 0.0f; }
+
+            iterator begin() noexcept { return iterator(this, 0); }
+            iterator end() noexcept { return iterator(this, slot_count); }
+            const_iterator begin() const noexcept { return const_iterator(this, 0); }
+            const_iterator end() const noexcept { return const_iterator(this, slot_count); }
+
+            void swap(flat_map& rhs) noexcept
+            {
+                std::swap(ctrl, rhs.ctrl);
+                std::swap(slots, rhs.slots);
+                std::swap(slot_count, rhs.slot_count);
+                std::swap(count, rhs.count);
+                std::swap(growth_left, rhs.growth_left);
+            }
+
+        private:
+            constexpr static std::size_t NOT_FOUND = ~std::size_t{0};
+
+            // 7/8 maximum load
+            constexpr static std::size_t max_load(std::size_t slots) noexcept { return slots - slots / 8; }
+
+            static std::size_t hash_of(const K& key) noexcept { return detail::mix_hash(Hash{}(key)); }
+            static std::int8_t h2(std::size_t hash) noexcept { return static_cast<std::int8_t>(hash & 0x7f); }
+            static std::size_t h1(std::size_t hash) noexcept { return hash >> 7; }
+
+            std::size_t find_index(const K& key) const noexcept { return find_index(key, hash_of(key)); }
+
+            std::size_t find_index(const K& key, std::size_t hash) const noexcept
+            {
+                if (slot_count == 0)
+                    return NOT_FOUND;
+
+                const std::size_t group_mask = slot_count / GROUP_WIDTH - 1;
+                std::size_t g = h1(hash) & group_mask;
+
+                for (std::size_t step = 1;; ++step) {
+                    const group current(ctrl + g * GROUP_WIDTH);
+
+                    for (std::uint32_t mask = current.match(h2(hash)); mask != 0; mask &= mask - 1) {
+                        const std::size_t index = g * GROUP_WIDTH + detail::lowest_bit_index(mask);
+                        if (Eq{}(slots[index].key, key))
+                            return index;
+                    }
+
+                    if (current.match_empty() != 0)
+                        return NOT_FOUND;
+
+                    g = (g + step) & group_mask;
+                }
+            }
+
+            // Finds a free slot for a key known to be absent, growing if needed
+            std::size_t prepare_insert(std::size_t hash)
+            {
+                if (growth_left == 0) {
+                    // mostly tombstones, clean them up without growing
+                    if (slot_count != 0 && count * 2 <= max_load(slot_count))
+                        rehash(slot_count);
+                    else
+                        rehash(slot_count == 0? GROUP_WIDTH : slot_count * 2);
+                }
+
+                return find_free(hash);
+            }
+
+            // Marks a slot from prepare_insert as holding a value
+            void claim(std::size_t index, std::size_t hash) noexcept
+            {
+                if (ctrl[index] == detail::CONTROL_EMPTY)
+                    growth_left--;
+
+                ctrl[index] = h2(hash);
+                count++;
+            }
+
+            std::size_t find_free(std::size_t hash) const noexcept
+            {
+                const std::size_t group_mask = slot_count / GROUP_WIDTH - 1;
+                std::size_t g = h1(hash) & group_mask;
+
+                for (std::size_t step = 1;; ++step) {
+                    const std::uint32_t mask = group(ctrl + g * GROUP_WIDTH).match_empty_or_deleted();
+                    if (mask != 0)
+                        return g * GROUP_WIDTH + detail::lowest_bit_index(mask);
+                    g = (g + step) & group_mask;
+                }
+            }
+
+            struct ctrl_deleter
+            {
+                void operator()(std::int8_t* bytes) const noexcept { ::operator delete(bytes, std::align_val_t{GROUP_WIDTH}); }
+            };
+
+            void rehash(std::size_t new_count)
+            {
+                // the control bytes are freed if allocating the slots throws
+                std::unique_ptr<std::int8_t, ctrl_deleter> new_ctrl(
+                    static_cast<std::int8_t*>(::operator new(new_count, std::align_val_t{GROUP_WIDTH})));
+                slot_type* new_slots = static_cast<slot_type*>(::operator new(new_count * sizeof(slot_type),
+                                                                              std::align_val_t{alignof(slot_type)}));
+
+                std::int8_t* old_ctrl = ctrl;
+                slot_type* old_slots = slots;
+                const std::size_t old_count = slot_count;
+
+                ctrl = new_ctrl.release();
+                slots = new_slots;
+                slot_count = new_count;
+                growth_left = max_load(new_count) - count;
+
+                for (std::size_t i = 0; i < new_count; ++i)
+                    ctrl[i] = detail::CONTROL_EMPTY;
+
+                for (std::size_t i = 0; i < old_count; ++i) {
+                    if (old_ctrl[i] < 0)
+                        continue;
+
+                    const std::size_t hash = hash_of(old_slots[i].key);
+                    const std::size_t index = find_free(hash);
+                    ctrl[index] = h2(hash);
+                    new (&slots[index]) slot_type(::roc::move(old_slots[i]));
+                    old_slots[i].~slot_type();
+                }
+
+                release(old_ctrl, old_slots);
+            }
+
+            void destroy_values() noexcept
+            {
+                if constexpr (not std::is_trivially_destructible<slot_type>::value)
+                    for (std::size_t i = 0; i < slot_count; ++i)
+                        if (ctrl[i] >= 0)
+                            slots[i].~slot_type();
+            }
+
+            void destroy() noexcept
+            {
+                destroy_values();
+                release(ctrl, slots);
+                ctrl = nullptr;
+                slots = nullptr;
+                slot_count = count = growth_left = 0;
+            }
+
+            static void release(std::int8_t* old_ctrl, slot_type* old_slots) noexcept
+            {
+                if (old_ctrl == nullptr)
+                    return;
+                ::operator delete(old_ctrl, std::align_val_t{GROUP_WIDTH});
+                ::operator delete(old_slots, std::align_val_t{alignof(slot_type)});
+            }
+
+            std::int8_t* ctrl = nullptr;
+            slot_type* slots = nullptr;
+            std::size_t slot_count = 0;
+            std::size_t count = 0;
+            std::size_t growth_left = 0;
+    };
+}
+
+#endif
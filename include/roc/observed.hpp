@@ -0,0 +1,106 @@
+#ifndef ROC_OBSERVED_HPP
+#define ROC_OBSERVED_HPP
+
+// Unchecked error detection, compiled in with ROC_CHECK_OBSERVED.
+//
+// Every result carries a checked bit, which is_ok, is_err and everything
+// built on them (unwrap, contains, the combinators...) set.  Destroying an
+// Err that was never checked calls the unobserved error handler with the
+// location the Err was created at.  Copies have to be checked on their own,
+// moving a result out counts as checking the one moved from.  Without the
+// macro the bookkeeping is an empty base and costs nothing.
+
+#include "utility.hpp"
+
+#if defined (ROC_CHECK_OBSERVED)
+#include <atomic>
+#include <cstdint>
+#include <source_location>
+
+namespace roc
+{
+    using unobserved_error_handler = void (*)(const std::source_location& origin) noexcept;
+
+    namespace detail
+    {
+        inline void abort_on_unobserved_error(const std::source_location&) noexcept { std::abort(); }
+
+        inline constinit std::atomic<unobserved_error_handler> unobserved_handler {abort_on_unobserved_error};
+        inline constinit std::atomic<std::uint64_t> unobserved_errors {0};
+    }
+
+    // Handler that only lets the error be counted
+    inline void ignore_unobserved_error(const std::source_location&) noexcept {}
+
+    // The default handler aborts, returns the previous one
+    inline unobserved_error_handler set_unobserved_error_handler(unobserved_error_handler handler) noexcept
+    {
+        return detail::unobserved_handler.exchange(handler);
+    }
+
+    // Unchecked errors destroyed so far, whatever the handler did with them
+    inline std::uint64_t unobserved_error_count() noexcept
+    {
+        return detail::unobserved_errors.load(std::memory_order_relaxed);
+    }
+
+    namespace detail
+    {
+        [[gnu::cold]] inline void report_unobserved_error(const std::source_location& origin) noexcept
+        {
+            unobserved_errors.fetch_add(1, std::memory_order_relaxed);
+            unobserved_handler.load(std::memory_order_acquire)(origin);
+        }
+
+        struct observation
+        {
+            constexpr observation() noexcept = default;
+            constexpr observation(const observation& other) noexcept : origin(other.origin) {}
+            constexpr observation(observation&& other) noexcept : origin(other.origin) { other.observed = true; }
+
+            constexpr observation& operator=(const observation& other) noexcept
+            {
+                observed = false;
+                origin = other.origin;
+                return *this;
+            }
+            constexpr observation& operator=(observation&& other) noexcept
+            {
+                observed = false;
+                origin = other.origin;
+                other.observed = true;
+                return *this;
+            }
+
+            constexpr void observe() const noexcept { observed = true; }
+
+            template <typename Wrapped>
+            constexpr void take_origin(const Wrapped& error) noexcept
+            {
+                observed = false;
+                origin = error.origin;
+            }
+
+            constexpr void check_observed(bool is_error) const noexcept
+            {
+                if (is_error && not observed && not std::is_constant_evaluated())
+                    report_unobserved_error(origin);
+            }
+
+            mutable bool            observed = false;
+            std::source_location    origin {};
+        };
+    }
+}
+#else
+namespace roc::detail
+{
+    struct observation
+    {
+        constexpr void observe() const noexcept {}
+        template <typename Wrapped> constexpr void take_origin(const Wrapped&) noexcept {}
+    };
+}
+#endif
+
+#endif
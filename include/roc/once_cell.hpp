@@ -0,0 +1,180 @@
+#ifndef ROC_ONCE_CELL_HPP
+#define ROC_ONCE_CELL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "utility.hpp"
+#include "option.hpp"
+#include "result.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+        template <typename R, typename T> struct once_cell_init_traits
+        {
+            static_assert(dependent_false<R>(), "initialiser must return roc::result<T, E>");
+        };
+
+        template <typename T, typename E> struct once_cell_init_traits<result<T, E>, T>
+        {
+            using error_type = E;
+        };
+    }
+
+    // Thread-safe cell that is written once.
+    //
+    // The value lives in option_storage next to the state word, so there is no
+    // separate once_flag, and reading an initialised cell is a single acquire
+    // load.  Threads racing to initialise wait for the winner instead of running
+    // the initialiser twice.
+    template <typename T>
+    class once_cell
+    {
+        static_assert(not std::is_reference<T>::value, "once_cell cannot hold a reference");
+        static_assert(not std::is_void<T>::value, "once_cell cannot hold void");
+
+        enum state_type : std::uint8_t { EMPTY, RUNNING, READY };
+
+        public:
+            using value_type = T;
+
+            constexpr once_cell() noexcept = default;
+            once_cell(const once_cell&) = delete;
+            once_cell& operator=(const once_cell&) = delete;
+
+            bool is_initialised() const noexcept { return state.load(std::memory_order_acquire) == READY; }
+
+            option<const T&> get() const noexcept
+            {
+                if (state.load(std::memory_order_acquire) == READY)
+                    return option<const T&>{storage.get()};
+                return none_type{};
+            }
+
+            option<T&> get_mut() noexcept
+            {
+                if (state.load(std::memory_order_acquire) == READY)
+                    return option<T&>{storage.get()};
+                return none_type{};
+            }
+
+            // Runs f if the cell is empty, and returns the stored value
+            template <typename Func>
+            T& get_or_init(Func&& f)
+            {
+                if (state.load(std::memory_order_acquire) == READY)
+                    return storage.get();
+
+                if (acquire_init()) {
+                    running_guard guard { *this };
+                    storage.construct(std::invoke(::roc::forward<Func>(f)));
+                    guard.publish();
+                }
+                return storage.get();
+            }
+
+            // Like get_or_init, but f returns result<T, E>.  On Err, the cell is
+            // left empty so a later call can try again, and the error is returned.
+            template <typename Func,
+                      typename R = std::invoke_result_t<Func>,
+                      typename E = typename detail::once_cell_init_traits<R, T>::error_type>
+            result<T&, E> try_get_or_init(Func&& f)
+            {
+                if (state.load(std::memory_order_acquire) == READY)
+                    return import::Ok(storage.get());
+
+                if (acquire_init()) {
+                    running_guard guard { *this };
+                    R res = std::invoke(::roc::forward<Func>(f));
+                    if (res.is_err())
+                        return propagate(::roc::move(res));
+
+                    storage.construct(::roc::move(res).unwrap());
+                    guard.publish();
+                }
+                return import::Ok(storage.get());
+            }
+
+            // Sets the value if the cell was empty, otherwise hands it back
+            template <typename U> requires (std::is_constructible<T, U&&>::value)
+            result<void, T> set(U&& value)
+            {
+                if (not acquire_init())
+                    return import::Err(T(::roc::forward<U>(value)));
+
+                running_guard guard { *this };
+                storage.construct(::roc::forward<U>(value));
+                guard.publish();
+                return import::Ok();
+            }
+
+        private:
+            // Restores EMPTY if the initialiser bails out, by Err or by exception
+            struct running_guard
+            {
+                once_cell& cell;
+                state_type final_state = EMPTY;
+
+                void publish() noexcept { final_state = READY; }
+
+                ~running_guard()
+                {
+                    cell.state.store(final_state, std::memory_order_release);
+                    cell.state.notify_all();
+                }
+            };
+
+            // true when the caller now owns the initialisation (state is
+            // RUNNING), false when the cell is READY
+            bool acquire_init() noexcept
+            {
+                auto current = state.load(std::memory_order_acquire);
+                for (;;) {
+                    if (current == READY)
+                        return false;
+
+                    if (current == RUNNING) {
+                        state.wait(RUNNING, std::memory_order_acquire);
+                        current = state.load(std::memory_order_acquire);
+                        continue;
+                    }
+
+                    if (state.compare_exchange_weak(current, RUNNING, std::memory_order_acquire,
+                                                                      std::memory_order_acquire))
+                        return true;
+                }
+            }
+
+            std::atomic<state_type> state { EMPTY };
+            detail::option_opers<T> storage;
+    };
+
+    // Value computed on first access, with the initialiser stored alongside
+    template <typename T, typename Init>
+    class lazy
+    {
+        public:
+            using value_type = T;
+
+            constexpr explicit lazy(Init init) : initialiser(::roc::move(init)) {}
+
+            T& get() { return cell.get_or_init(initialiser); }
+
+            T& operator*() { return get(); }
+            T* operator->() { return &get(); }
+
+            bool is_initialised() const noexcept { return cell.is_initialised(); }
+
+        private:
+            Init initialiser;
+            once_cell<T> cell;
+    };
+
+    template <typename Init>
+    lazy(Init) -> lazy<std::invoke_result_t<Init&>, Init>;
+}
+
+#endif
@@ -15,6 +15,12 @@ namespace roc {
         bad_option_access() = default;
         const char *what() const noexcept override { return "Optional has no value"; }
     };
+
+    struct bad_option_value : public std::exception
+    {
+        bad_option_value() = default;
+        const char *what() const noexcept override { return "Value is the niche the option stores None as"; }
+    };
 }
 #endif
 
@@ -23,8 +29,151 @@ namespace roc {
 
 namespace roc
 {
+    // Niche policy for option: None is stored as a value T can never have in
+    // practice, so the option is exactly sizeof(T) with no separate flag.
+    // A policy provides none() and is_none(const T&).
+    template <typename T, T Sentinel>
+    struct sentinel_niche
+    {
+        constexpr static T none() noexcept { return Sentinel; }
+        constexpr static bool is_none(const T& value) noexcept { return value == Sentinel; }
+    };
+
+    // Niche policy for float / double: None is a quiet NaN with a payload that
+    // arithmetic never produces (it only propagates payloads it is given, and
+    // None never reaches user arithmetic).  Compared bitwise, so every other
+    // NaN is an ordinary Some.
+    template <typename T>
+    struct nan_niche
+    {
+        static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value,
+                      "nan_niche needs an IEEE-754 float or double");
+
+        // quiet bit and the top payload bit set, so small payloads from nan("n")
+        // don't collide; storing Some of exactly this NaN reads back as None
+        using bits_type = std::conditional_t<sizeof(T) == 8, unsigned long long, unsigned int>;
+        constexpr static bits_type NONE_BITS = sizeof(T) == 8? bits_type(0x7ffc4e4f4e454e4full) : bits_type(0x7fe04e4fu);
+
+        constexpr static T none() noexcept { return __builtin_bit_cast(T, NONE_BITS); }
+        constexpr static bool is_none(const T& value) noexcept { return __builtin_bit_cast(bits_type, value) == NONE_BITS; }
+    };
+
+    // Niche policy for pointers and owning pointers (unique_ptr), None is null.
+    // Some(nullptr) would read back as None, so it is rejected with
+    // bad_option_value, and at compile time in constant expressions.  Only
+    // used when asked for with null_option, plain option<T*> keeps null as a
+    // valid Some.
+    template <typename T>
+    struct null_niche
+    {
+        constexpr static T none() noexcept { return T{}; }
+        constexpr static bool is_none(const T& value) noexcept { return value == nullptr; }
+
+        constexpr static void check_some(const T& value)
+        {
+            if (value == nullptr)
+                THROW_OR_PANIC(bad_option_value());
+        }
+    };
+
     namespace detail
     {
+        // Something for the None of a view to point at, the element is never
+        // constructed, only its address is used
+        template <typename Element>
+        struct view_anchor
+        {
+            constexpr view_anchor() noexcept : unused() {}
+            ~view_anchor() requires std::is_trivially_destructible<Element>::value = default;
+            constexpr ~view_anchor() {}
+
+            union {
+                char    unused;
+                Element element;
+            };
+        };
+
+        template <typename Element>
+        inline constinit view_anchor<Element> view_none_anchor {};
+    }
+
+    // Niche policy for pointer + length views (string_view, span), None is an
+    // empty view of an object private to roc, which no view handed to an
+    // option points at.  It is a valid range, so the view is an ordinary
+    // value and everything stays constexpr, and an empty Some(view{}) stays
+    // Some.
+    template <typename T>
+    struct view_niche
+    {
+        using element_type = std::remove_pointer_t<decltype(::roc::declval<const T&>().data())>;
+
+        constexpr static element_type* anchor() noexcept { return &detail::view_none_anchor<std::remove_cv_t<element_type>>.element; }
+
+        constexpr static T none() noexcept { return T(anchor(), 0); }
+        constexpr static bool is_none(const T& value) noexcept { return value.size() == 0 && value.data() == anchor(); }
+    };
+
+    // Niche policy for bool, None is the byte 2, which no bool holds.  The byte
+    // is only ever written and inspected as unsigned char, never read as a
+    // bool.
+    struct bool_niche
+    {
+        constexpr static unsigned char NONE_BYTE = 2;
+
+        constexpr static void set_none(unsigned char (&bytes)[sizeof(bool)]) noexcept { bytes[0] = NONE_BYTE; }
+        constexpr static bool is_none(const unsigned char (&bytes)[sizeof(bool)]) noexcept { return bytes[0] == NONE_BYTE; }
+    };
+
+    // Storage policy that always keeps the separate presence flag, for when
+    // every value of T has to stay distinct from None
+    struct no_niche {};
+
+    namespace detail
+    {
+        // matched by shape, so the std headers aren't needed here
+        template <typename T>
+        concept pointer_length_view = std::is_trivially_copyable<T>::value
+            && requires (const T& view) {
+                requires std::is_pointer<decltype(view.data())>::value;
+                requires std::is_same<decltype(view.size()), std::size_t>::value;
+                T(view.data(), view.size());
+            }
+            && (not requires { T::extent; } || T::extent == ~std::size_t{0}); // no fixed extent spans
+    }
+
+    // Customisation point, the niche plain option<T> uses.  void keeps the
+    // separate presence flag.
+    template <typename T> struct option_niche { using type = void; };
+
+    template <> struct option_niche<bool> { using type = bool_niche; };
+    template <detail::pointer_length_view T> struct option_niche<T> { using type = view_niche<T>; };
+
+    #if defined (ROC_ENABLE_NAN_BOXED_OPTION)
+    template <> struct option_niche<float> { using type = nan_niche<float>; };
+    template <> struct option_niche<double> { using type = nan_niche<double>; };
+    #endif
+
+    namespace detail
+    {
+        template <typename Policy>
+        concept niche_policy = requires { &Policy::is_none; };
+
+        // the niche is a representation T can't hold as a value, so it is
+        // written into the bytes of T with set_none instead of assigned from
+        // none()
+        template <typename Niche, typename T>
+        concept representation_niche = requires (unsigned char (&bytes)[sizeof(T)]) { Niche::set_none(bytes); };
+
+        // the niche rejects a Some that would read back as None
+        template <typename Niche, typename T>
+        concept checked_niche = requires (const T& value) { Niche::check_some(value); };
+
+        // option<T, Policy> uses Policy when it is a niche, otherwise whatever
+        // option_niche<T> says, which is the separate flag unless specialised
+        template <typename T, typename Policy> struct niche_for { using type = typename option_niche<T>::type; };
+        template <typename T, niche_policy Policy> struct niche_for<T, Policy> { using type = Policy; };
+        template <typename T> struct niche_for<T, no_niche> { using type = void; };
+
         template <typename T,
                   bool IsTriviallyDestructible = std::is_trivially_destructible<T>::value,
                   bool IsReference = std::is_reference<T>::value>
@@ -33,46 +182,51 @@ namespace roc
         template <typename T>
         struct option_storage<T, TRIVIALLY_DESTRUCTIBLE_VALUE, NOT_REFERENCE>
         {
-            constexpr option_storage() noexcept(std::is_nothrow_default_constructible<T>::value)
-                : contains_value(false) {}
+            constexpr option_storage() noexcept : uninitialised(), contains_value(false) {}
 
             template <typename... Args> requires std::is_constructible<T, Args&&...>::value
             constexpr option_storage(tags::in_place, Args&&... args) noexcept(
                     std::is_nothrow_constructible<T, Args&&...>::value)
-                : stored_value(forward<Args>(args)...), contains_value(true) {}
+                : stored_value(::roc::forward<Args>(args)...), contains_value(true) {}
 
             template <typename U, typename... Args> requires std::is_constructible<T, std::initializer_list<U>&, Args&&...>::value
             constexpr option_storage(tags::in_place, std::initializer_list<T> il, Args&&... args) noexcept(
                     std::is_nothrow_constructible<T, std::initializer_list<U>&, Args&&...>::value)
-                : stored_value(il, forward<Args>(args)...), contains_value(true) {}
+                : stored_value(il, ::roc::forward<Args>(args)...), contains_value(true) {}
 
             ~option_storage() = default;
 
-            T stored_value;
+            union {
+                T       stored_value;
+                char    uninitialised;
+            };
             bool contains_value;
         };
 
         template <typename T>
         struct option_storage<T, NOT_TRIVIALLY_DESTRUCTIBLE_VALUE, NOT_REFERENCE>
         {
-            constexpr option_storage() noexcept : contains_value(false) {}
+            constexpr option_storage() noexcept : uninitialised(), contains_value(false) {}
 
             template <typename... Args> requires std::is_constructible<T, Args&&...>::value
             constexpr option_storage(tags::in_place, Args&&... args) noexcept(
                     std::is_nothrow_constructible<T, Args&&...>::value)
-                : stored_value(forward<Args>(args)...), contains_value(true) {}
+                : stored_value(::roc::forward<Args>(args)...), contains_value(true) {}
 
             template <typename U, typename... Args> requires std::is_constructible<T, std::initializer_list<U>&, Args&&...>::value
             constexpr option_storage(tags::in_place, std::initializer_list<T> il, Args&&... args) noexcept(
                     std::is_nothrow_constructible<T, std::initializer_list<U>&, Args&&...>::value)
-                : stored_value(il, forward<Args>(args)...), contains_value(true) {}
+                : stored_value(il, ::roc::forward<Args>(args)...), contains_value(true) {}
 
             ~option_storage() {
                 if (contains_value)
                     stored_value.~T();
             }
 
-            T stored_value;
+            union {
+                T       stored_value;
+                char    uninitialised;
+            };
             bool contains_value;
         };
 
@@ -89,22 +243,173 @@ namespace roc
         template <typename T, bool DONT_CARE>
         struct option_storage<T, DONT_CARE, IS_REFERENCE>
         {
-            const std::decay_t<T>* stored_pointer = nullptr;
+            std::remove_reference_t<T>* stored_pointer = nullptr;
         };
 
+        // The value is always alive, None is just the niche value of it
+        template <typename T, typename Niche>
+        struct niche_option_storage
+        {
+            static_assert(not std::is_reference<T>::value, "niche option cannot hold references");
 
-        template <typename T>
-        struct option_opers : option_storage<T>
+            constexpr niche_option_storage() noexcept(noexcept(Niche::none())) : stored_value(Niche::none()) {}
+
+            template <typename... Args> requires std::is_constructible<T, Args&&...>::value
+            constexpr niche_option_storage(tags::in_place, Args&&... args) noexcept(
+                    std::is_nothrow_constructible<T, Args&&...>::value && not checked_niche<Niche, T>)
+                : stored_value(::roc::forward<Args>(args)...)
+            {
+                if constexpr (checked_niche<Niche, T>)
+                    Niche::check_some(stored_value);
+            }
+
+            constexpr bool holds_none() const noexcept { return Niche::is_none(stored_value); }
+            constexpr void make_none() noexcept { stored_value = Niche::none(); }
+
+            T stored_value;
+        };
+
+        // Copies have to carry the niche byte over, so the value shares a union
+        // with its bytes, and a union copies its object representation.  None
+        // makes the bytes the active member, Some the value.
+        template <typename T, typename Niche> requires representation_niche<Niche, T>
+        struct niche_option_storage<T, Niche>
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "representation niche needs a trivially copyable type");
+
+            constexpr niche_option_storage() noexcept : representation() { Niche::set_none(representation); }
+
+            template <typename... Args> requires std::is_constructible<T, Args&&...>::value
+            constexpr niche_option_storage(tags::in_place, Args&&... args) noexcept(
+                    std::is_nothrow_constructible<T, Args&&...>::value)
+                : stored_value(::roc::forward<Args>(args)...) {}
+
+            constexpr bool holds_none() const noexcept
+            {
+                // Constant evaluation can't read the bytes of a value, but
+                // only the active member is a constant there, so a live value
+                // is a Some.  Reading the bytes of anything else still has to
+                // be a constant expression.
+                if (std::is_constant_evaluated() && __builtin_constant_p(stored_value))
+                    return false;
+                return Niche::is_none(representation);
+            }
+
+            // writing the bytes by subscript is what makes them the active
+            // member in constant evaluation
+            constexpr void make_none() noexcept
+            {
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                    representation[i] = 0;
+                Niche::set_none(representation);
+            }
+
+            union {
+                T               stored_value;
+                unsigned char   representation[sizeof(T)];
+            };
+        };
+
+        template <typename T, typename Niche>
+        using option_storage_for = std::conditional_t<std::is_void<Niche>::value,
+                                                      option_storage<T>,
+                                                      niche_option_storage<T, Niche>>;
+
+
+        template <typename T, typename Niche = void>
+        struct option_opers : option_storage_for<T, Niche>
         {
-            using option_storage<T>::option_storage;
+            using storage_type = option_storage_for<T, Niche>;
+            using storage_type::storage_type;
+
+            // niche storage always holds a live value, so its members are plain
+            constexpr static bool HAS_NICHE = not std::is_void<Niche>::value;
 
-            template <typename... Args> constexpr void construct(Args&&... args) noexcept
+            constexpr option_opers() = default;
+
+            // The storage keeps the value in an union, so anything that isn't trivial
+            // has to be copied / moved by hand, depending on the state of the source.
+            constexpr option_opers(const option_opers&) requires (HAS_NICHE || std::is_trivially_copy_constructible<T>::value) = default;
+            constexpr option_opers(const option_opers& rhs) noexcept(std::is_nothrow_copy_constructible<T>::value)
+                requires (not HAS_NICHE && not std::is_trivially_copy_constructible<T>::value && std::is_copy_constructible<T>::value)
+                : storage_type()
+            {
+                if (rhs.has_value())
+                    construct_with(rhs);
+            }
+
+            constexpr option_opers(option_opers&&) requires (HAS_NICHE || std::is_trivially_move_constructible<T>::value) = default;
+            constexpr option_opers(option_opers&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+                requires (not HAS_NICHE && not std::is_trivially_move_constructible<T>::value && std::is_move_constructible<T>::value)
+                : storage_type()
+            {
+                if (rhs.has_value())
+                    construct_with(::roc::move(rhs));
+            }
+
+            constexpr option_opers& operator=(const option_opers&) requires (HAS_NICHE
+                                                                          || (std::is_trivially_copy_assignable<T>::value
+                                                                           && std::is_trivially_copy_constructible<T>::value
+                                                                           && std::is_trivially_destructible<T>::value)) = default;
+            constexpr option_opers& operator=(const option_opers& rhs) noexcept(std::is_nothrow_copy_assignable<T>::value
+                                                                              && std::is_nothrow_copy_constructible<T>::value)
+                requires (not HAS_NICHE
+                          && not (std::is_trivially_copy_assignable<T>::value
+                            && std::is_trivially_copy_constructible<T>::value
+                            && std::is_trivially_destructible<T>::value)
+                          && std::is_copy_assignable<T>::value && std::is_copy_constructible<T>::value)
+            {
+                assign_from(rhs);
+                return *this;
+            }
+
+            constexpr option_opers& operator=(option_opers&&) requires (HAS_NICHE
+                                                                     || (std::is_trivially_move_assignable<T>::value
+                                                                      && std::is_trivially_move_constructible<T>::value
+                                                                      && std::is_trivially_destructible<T>::value)) = default;
+            constexpr option_opers& operator=(option_opers&& rhs) noexcept(std::is_nothrow_move_assignable<T>::value
+                                                                         && std::is_nothrow_move_constructible<T>::value)
+                requires (not HAS_NICHE
+                          && not (std::is_trivially_move_assignable<T>::value
+                            && std::is_trivially_move_constructible<T>::value
+                            && std::is_trivially_destructible<T>::value)
+                          && std::is_move_assignable<T>::value && std::is_move_constructible<T>::value)
+            {
+                assign_from(::roc::move(rhs));
+                return *this;
+            }
+
+            template <typename Rhs> constexpr void assign_from(Rhs&& rhs)
                 requires(not std::is_reference<T>::value)
             {
-                new(&(this->stored_value)) T(forward<Args>(args)...);
-                this->contains_value = true;
+                if (this == &rhs)
+                    return;
+
+                if (this->has_value() && rhs.has_value())
+                    get() = ::roc::forward<Rhs>(rhs).get();
+                else if (rhs.has_value())
+                    construct_with(::roc::forward<Rhs>(rhs));
+                else if (this->has_value())
+                    reset();
+            }
+
+            // a checked niche throws or panics on a Some that would be None
+            constexpr static bool NOTHROW_SOME = not checked_niche<Niche, T>;
+
+            template <typename... Args> constexpr void construct(Args&&... args) noexcept(NOTHROW_SOME)
+                requires(not std::is_reference<T>::value)
+            {
+                if constexpr (HAS_NICHE) {
+                    this->stored_value = T(::roc::forward<Args>(args)...);
+                    if constexpr (checked_niche<Niche, T>)
+                        Niche::check_some(this->stored_value);
+                } else {
+                    new(&(this->stored_value)) T(::roc::forward<Args>(args)...);
+                    this->contains_value = true;
+                }
             }
             template <typename V> constexpr void construct(V& target) noexcept
+                requires(std::is_reference<T>::value)
             {
                 this->stored_pointer = &target;
             }
@@ -112,12 +417,17 @@ namespace roc
             template <typename Moved> constexpr void construct_with(Moved&& rhs) noexcept
                 requires(not std::is_reference<T>::value)
             {
-                new(&(this->stored_value)) T(forward<Moved>(rhs).get());
+                new(&(this->stored_value)) T(::roc::forward<Moved>(rhs).get());
                 this->contains_value = true;
             }
 
             constexpr bool has_value() const requires (not std::is_reference<T>::value)
-                { return this->contains_value; }
+            {
+                if constexpr (HAS_NICHE)
+                    return not this->holds_none();
+                else
+                    return this->contains_value;
+            }
 
             constexpr bool has_value() const requires (std::is_reference<T>::value)
                 { return this->stored_pointer != nullptr; }
@@ -138,20 +448,31 @@ namespace roc
 
             constexpr T&& get() && { 
                 if constexpr (std::is_reference<T>::value)
-                    return move(*(this->stored_pointer));
+                    return *(this->stored_pointer); // T&& collapses to T&, nothing to move
                 else
-                    return move(this->stored_value);
+                    return ::roc::move(this->stored_value);
             }
 
             constexpr const T&& get() const && {
                 // this doesn't make any sense?
                 if constexpr (std::is_reference<T>::value)
-                    return const_cast<const T&&>(move(*(this->stored_pointer)));
+                    return *(this->stored_pointer);
                 else
-                    return move(this->stored_value);
+                    return ::roc::move(this->stored_value);
             }
 
             constexpr void destroy_value() { get().~T(); }
+
+            constexpr void reset() noexcept requires(not std::is_reference<T>::value)
+            {
+                if constexpr (HAS_NICHE) {
+                    this->make_none();
+                } else if (this->contains_value) {
+                    if constexpr (not std::is_trivially_destructible<T>::value)
+                        destroy_value();
+                    this->contains_value = false;
+                }
+            }
         };
 
         template <>
@@ -164,53 +485,66 @@ namespace roc
         };
     }
 
-    template <typename T, typename = boolopt<std::is_reference_v<T>>>
-    struct option : detail::option_opers<T>
+    template <typename T, typename Policy> struct option;
+
+    namespace detail
+    {
+        template <typename T> struct is_option : std::false_type {};
+        template <typename T, typename Policy> struct is_option<option<T, Policy>> : std::true_type {};
+    }
+
+    // Policy is boolopt<is reference> by default, or a niche policy such as
+    // sentinel_niche, which changes only the storage, not the interface.
+    template <typename T, typename Policy = boolopt<std::is_reference_v<T>>>
+    struct [[nodiscard]] option : detail::option_opers<T, typename detail::niche_for<T, Policy>::type>
     {
         using value_type = T;
 
         constexpr option() = default;
-        constexpr option(none_type) noexcept { this->contains_value = false; }
+        constexpr option(none_type) noexcept {}
 
         template <typename... Args>
-        explicit constexpr option(Args&&... args) noexcept { this->construct(forward<Args...>(args...)); }
+            requires (sizeof...(Args) != 1 || not (detail::is_option<std::remove_cvref_t<Args>>::value || ...))
+        explicit constexpr option(Args&&... args) noexcept(option::NOTHROW_SOME) { this->construct(::roc::forward<Args...>(args...)); }
+
+        // Converts between options of the same value with different storage,
+        // so Some(x) can be assigned to a sentinel_option
+        template <typename U, typename P>
+            requires (std::is_same<std::remove_cvref_t<U>, T>::value && not std::is_same<option<U, P>, option>::value)
+        constexpr option(const option<U, P>& other) noexcept(option::NOTHROW_SOME)
+        {
+            if (other.is_some())
+                this->construct(other.unwrap());
+        }
 
-        constexpr bool is_some() const noexcept { return this->has_value(); } 
-        constexpr bool is_none() const noexcept { return !this->has_value(); }
+        [[nodiscard]] constexpr bool is_some() const noexcept { return this->has_value(); } 
+        [[nodiscard]] constexpr bool is_none() const noexcept { return !this->has_value(); }
 
         template <typename U>
-        constexpr bool contains(U&& compare) const noexcept { return is_some() && this->stored_value == compare; }
+        [[nodiscard]] constexpr bool contains(U&& compare) const noexcept { return is_some() && this->stored_value == compare; }
 
         constexpr const T& unwrap() const & {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return this->get();
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return this->get();
         }
         constexpr T& unwrap() & {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return this->get();
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return this->get();
         }
 
         constexpr T&& unwrap() && {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return move(this->get());
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return ::roc::move(this->get());
         }
         constexpr const T&& unwrap() const&& {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return move(this->get());
-        }
-
-        template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr const T& unwrap_or(U&& v) const & {
-            return is_some()? unwrap() : static_cast<T>(forward<U>(v));
-        }
-        template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr T& unwrap_or(U&& v) & {
-            return is_some()? unwrap() : static_cast<T>(forward<U>(v));
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return ::roc::move(this->get());
         }
 
+        // by value, the fallback is a temporary
         template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr const T&& unwrap_or(U&& v) const && {
-            return is_some()? move(unwrap()) : static_cast<T>(forward<U>(v));
+        constexpr T unwrap_or(U&& v) const& noexcept(std::is_nothrow_convertible<U&&, T>::value) {
+            return is_some()? unwrap() : static_cast<T>(::roc::forward<U>(v));
         }
         template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr T&& unwrap_or(U&& v) && {
-            return is_some()? move(unwrap()) : static_cast<T>(forward<U>(v));
+        constexpr T unwrap_or(U&& v) && noexcept(std::is_nothrow_convertible<U&&, T>::value) {
+            return is_some()? ::roc::move(unwrap()) : static_cast<T>(::roc::forward<U>(v));
         }
 
         template <typename Func>
@@ -219,65 +553,73 @@ namespace roc
             return is_some()? f(unwrap())
                 : result_type{none_type{}};
         }
+
+        template <typename Func>
+        constexpr auto map(Func&& f) {
+            using mapped_type = std::remove_cvref_t<typename std::invoke_result<Func, value_type&>::type>;
+            return is_some()? option<mapped_type>{f(unwrap())}
+                : option<mapped_type>{none_type{}};
+        }
     };
 
+    // option<T> with None stored in-band as Sentinel, sizeof(T) and trivially
+    // copyable for trivially copyable T.  Storing Some(Sentinel) reads back as None.
+    template <typename T, T Sentinel>
+    using sentinel_option = option<T, sentinel_niche<T, Sentinel>>;
+
+    // option<float> / option<double> with None as a reserved NaN, sizeof(T)
     template <typename T>
-    struct option<T, boolopt<true>> : detail::option_opers<T>
+    using nan_option = option<T, nan_niche<T>>;
+
+    // option<T*> / option<unique_ptr> with None as null, sizeof(T).  Some(nullptr)
+    // throws bad_option_value or panics.
+    template <typename T>
+    using null_option = option<T, null_niche<T>>;
+
+    template <typename T>
+    struct [[nodiscard]] option<T, boolopt<true>> : detail::option_opers<T>
     {
         using value_type = T;
 
         constexpr option() = default;
-        constexpr option(none_type) noexcept { this->contains_value = false; }
+        constexpr option(none_type) noexcept {}
         constexpr option(const option&) = default;
         constexpr option(option&&) = default;
 
         template <typename... Args>
-        explicit constexpr option(Args&&... args) noexcept { this->construct(forward<Args...>(args...)); }
+        explicit constexpr option(Args&&... args) noexcept { this->construct(::roc::forward<Args...>(args...)); }
 
         // The comments here are obvious, but the point is to show the comment line
         // with the error message when trying to do this in user program
         constexpr option& operator=(const option&) = delete; // do not allow rebinding a reference
         constexpr option&& operator=(option&&) = delete; // do not allow rebinding a reference
 
-        constexpr bool is_some() const noexcept { return this->has_value(); } 
-        constexpr bool is_none() const noexcept { return !this->has_value(); }
+        [[nodiscard]] constexpr bool is_some() const noexcept { return this->has_value(); } 
+        [[nodiscard]] constexpr bool is_none() const noexcept { return !this->has_value(); }
 
         template <typename U>
-        constexpr bool contains(U&& compare) const noexcept { return is_some() && this->stored_value == compare; }
+        [[nodiscard]] constexpr bool contains(U&& compare) const noexcept { return is_some() && this->get() == compare; }
 
         option& rebind(T&& t) && { this->construct(t); return *this; }
         option& rebind(T&& t) & { this->construct(t); return *this; }
 
         constexpr const T& unwrap() const & {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return this->get();
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return this->get();
         }
         constexpr T& unwrap() & {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return this->get();
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return this->get();
         }
 
         constexpr T&& unwrap() && {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return move(this->get());
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return this->get();
         }
         constexpr const T&& unwrap() const&& {
-            if (is_none()) THROW_OR_PANIC(bad_option_access()); else return move(this->get());
+            if (is_none()) THROW_OR_PANIC_UNWRAP(bad_option_access()); else return this->get();
         }
 
-        template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr const T& unwrap_or(U&& v) const & {
-            return is_some()? unwrap() : static_cast<T>(forward<U>(v));
-        }
-        template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr T& unwrap_or(U&& v) & {
-            return is_some()? unwrap() : static_cast<T>(forward<U>(v));
-        }
-
-        template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr const T&& unwrap_or(U&& v) const && {
-            return is_some()? move(unwrap()) : static_cast<T>(forward<U>(v));
-        }
-        template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
-        constexpr T&& unwrap_or(U&& v) && {
-            return is_some()? move(unwrap()) : static_cast<T>(forward<U>(v));
+        template <typename U> requires (std::is_convertible<U&&, T>::value)
+        constexpr T unwrap_or(U&& v) const noexcept {
+            return is_some()? this->get() : static_cast<T>(::roc::forward<U>(v));
         }
 
         template <typename Func>
@@ -308,14 +650,14 @@ namespace roc
     };
 
     template <>
-    struct option<void> : detail::option_opers<void>
+    struct [[nodiscard]] option<void> : detail::option_opers<void>
     {
         constexpr option() = default;
         constexpr option(none_type) noexcept { this->contains_value = false; }
         constexpr option(valid_void_type) noexcept { this->contains_value = true; }
 
-        constexpr bool is_some() const noexcept { return this->contains_value; }
-        constexpr bool is_none() const noexcept { return !this->contains_value; }
+        [[nodiscard]] constexpr bool is_some() const noexcept { return this->contains_value; }
+        [[nodiscard]] constexpr bool is_none() const noexcept { return !this->contains_value; }
     };
     
     #if defined (ROC_ENABLE_STD_STREAMS)
@@ -338,7 +680,7 @@ namespace roc::import
 {
     template <typename T>
     inline constexpr option<T> Some(T&& t) {
-        return option<T>{forward<T>(t)};
+        return option<T>{::roc::forward<T>(t)};
     }
 
     inline constexpr option<void> Some() noexcept {
@@ -0,0 +1,140 @@
+#ifndef ROC_OPTION_BOOL_VECTOR_HPP
+#define ROC_OPTION_BOOL_VECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utility.hpp"
+#include "option.hpp"
+
+namespace roc
+{
+    // Growable array of option<bool> at 2 bits an element.
+    //
+    // Every 64 elements take two words, one with the presence bits and one
+    // with the value bits, so counting the Some, true or false elements is a
+    // popcount per word.  Value bits of None elements are kept clear.
+    class option_bool_vector
+    {
+        using word_type = std::uint64_t;
+        constexpr static std::size_t WORD_BITS = 64;
+
+        struct block
+        {
+            word_type present = 0;
+            word_type value = 0;
+        };
+
+        public:
+            option_bool_vector() noexcept = default;
+            explicit option_bool_vector(std::size_t count) { resize(count); }
+
+            std::size_t size() const noexcept { return length; }
+            bool empty() const noexcept { return length == 0; }
+
+            // New elements are None
+            void resize(std::size_t count)
+            {
+                if (count < length)
+                    clear_from(count);
+                blocks.resize((count + WORD_BITS - 1) / WORD_BITS);
+                length = count;
+            }
+
+            void clear() noexcept
+            {
+                blocks.clear();
+                length = 0;
+            }
+
+            void push_back(option<bool> element)
+            {
+                if (length % WORD_BITS == 0)
+                    blocks.emplace_back();
+                set(length++, element);
+            }
+
+            option<bool> operator[](std::size_t index) const noexcept
+            {
+                const block& b = blocks[index / WORD_BITS];
+                const word_type bit = word_type{1} << (index % WORD_BITS);
+                if ((b.present & bit) == 0)
+                    return none_type{};
+                return option<bool>{(b.value & bit) != 0};
+            }
+
+            option<bool> get(std::size_t index) const
+            {
+                if (index >= length) THROW_OR_PANIC(bad_option_access());
+                return (*this)[index];
+            }
+
+            void set(std::size_t index, bool element) noexcept
+            {
+                block& b = blocks[index / WORD_BITS];
+                const word_type bit = word_type{1} << (index % WORD_BITS);
+                b.present |= bit;
+                b.value = element? (b.value | bit) : (b.value & ~bit);
+            }
+
+            void set(std::size_t index, option<bool> element) noexcept
+            {
+                if (element.is_some())
+                    set(index, element.unwrap());
+                else
+                    reset(index);
+            }
+
+            void reset(std::size_t index) noexcept
+            {
+                block& b = blocks[index / WORD_BITS];
+                const word_type bit = word_type{1} << (index % WORD_BITS);
+                b.present &= ~bit;
+                b.value &= ~bit;
+            }
+
+            std::size_t count_some() const noexcept
+            {
+                std::size_t count = 0;
+                for (const block& b : blocks)
+                    count += __builtin_popcountll(b.present);
+                return count;
+            }
+
+            std::size_t count_true() const noexcept
+            {
+                std::size_t count = 0;
+                for (const block& b : blocks)
+                    count += __builtin_popcountll(b.value);
+                return count;
+            }
+
+            std::size_t count_none() const noexcept { return length - count_some(); }
+
+            std::size_t count_false() const noexcept
+            {
+                std::size_t count = 0;
+                for (const block& b : blocks)
+                    count += __builtin_popcountll(b.present & ~b.value);
+                return count;
+            }
+
+        private:
+            // keeps the bits past the end clear, so the counts can take whole words
+            void clear_from(std::size_t index) noexcept
+            {
+                if (index % WORD_BITS == 0)
+                    return;
+                block& b = blocks[index / WORD_BITS];
+                const word_type keep = (word_type{1} << (index % WORD_BITS)) - 1;
+                b.present &= keep;
+                b.value &= keep;
+            }
+
+            std::vector<block> blocks;
+            std::size_t length = 0;
+    };
+}
+
+#endif
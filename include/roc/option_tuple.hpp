@@ -0,0 +1,258 @@
+#ifndef ROC_OPTION_TUPLE_HPP
+#define ROC_OPTION_TUPLE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "utility.hpp"
+#include "option.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+        template <std::size_t N>
+        using presence_mask_t = std::conditional_t<(N <= 8), std::uint8_t,
+                                std::conditional_t<(N <= 16), std::uint16_t,
+                                std::conditional_t<(N <= 32), std::uint32_t, std::uint64_t>>>;
+
+        // Byte offsets of the fields, placed in order of decreasing alignment
+        // so there is no padding between them.  Equal alignments keep the
+        // declaration order.
+        template <typename... Ts>
+        struct packed_layout
+        {
+            constexpr static std::size_t COUNT = sizeof...(Ts);
+            constexpr static std::size_t ALIGN = std::max({alignof(Ts)...});
+
+            struct offsets
+            {
+                std::size_t offset[COUNT];
+                std::size_t size;
+            };
+
+            constexpr static offsets compute() noexcept
+            {
+                constexpr std::size_t sizes[] = {sizeof(Ts)...};
+                constexpr std::size_t aligns[] = {alignof(Ts)...};
+
+                std::size_t order[COUNT] = {};
+                for (std::size_t i = 0; i < COUNT; ++i)
+                    order[i] = i;
+
+                for (std::size_t i = 1; i < COUNT; ++i)
+                    for (std::size_t j = i; j > 0 && aligns[order[j - 1]] < aligns[order[j]]; --j)
+                        std::swap(order[j - 1], order[j]);
+
+                offsets result{};
+                std::size_t end = 0;
+                for (std::size_t field : order) {
+                    end = (end + aligns[field] - 1) / aligns[field] * aligns[field];
+                    result.offset[field] = end;
+                    end += sizes[field];
+                }
+                result.size = end;
+                return result;
+            }
+
+            constexpr static offsets LAYOUT = compute();
+        };
+    }
+
+    // Fixed set of optional fields sharing one presence bitset.
+    //
+    // Instead of every option<T> member paying for its own padded flag, the
+    // flags live in the lowest unsigned integer that fits them, and the values
+    // are packed in raw storage in order of decreasing alignment.  Checking
+    // several fields at once is a single mask compare.
+    template <typename... Ts>
+    class option_tuple
+    {
+        static_assert(sizeof...(Ts) > 0 && sizeof...(Ts) <= 64, "option_tuple holds 1 to 64 fields");
+        static_assert((not std::is_reference<Ts>::value && ...), "option_tuple cannot hold references");
+
+        using layout = detail::packed_layout<Ts...>;
+
+        constexpr static bool TRIVIALLY_COPYABLE = (std::is_trivially_copyable<Ts>::value && ...);
+        constexpr static bool TRIVIALLY_DESTRUCTIBLE = (std::is_trivially_destructible<Ts>::value && ...);
+        constexpr static bool NOTHROW_MOVABLE = (std::is_nothrow_move_constructible<Ts>::value && ...);
+
+        public:
+            using mask_type = detail::presence_mask_t<sizeof...(Ts)>;
+
+            template <std::size_t I>
+            using element_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+            constexpr static std::size_t size() noexcept { return sizeof...(Ts); }
+
+            template <std::size_t... Is>
+            constexpr static mask_type mask_of() noexcept
+            {
+                static_assert(((Is < sizeof...(Ts)) && ...), "field index out of range");
+                return static_cast<mask_type>(((mask_type{1} << Is) | ... | mask_type{0}));
+            }
+
+            constexpr static mask_type ALL = static_cast<mask_type>(
+                static_cast<mask_type>(~mask_type{0}) >> (sizeof(mask_type) * 8 - sizeof...(Ts)));
+
+            option_tuple() noexcept = default;
+
+            // Delegating to the default constructor makes the tuple complete
+            // before any field is copied, so if a field throws, the destructor
+            // cleans up the ones already copied
+            option_tuple(const option_tuple&) requires (TRIVIALLY_COPYABLE) = default;
+            option_tuple(const option_tuple& rhs) requires (not TRIVIALLY_COPYABLE) : option_tuple() { copy_from(rhs); }
+
+            option_tuple(option_tuple&&) requires (TRIVIALLY_COPYABLE) = default;
+            option_tuple(option_tuple&& rhs) noexcept(NOTHROW_MOVABLE) requires (not TRIVIALLY_COPYABLE)
+                : option_tuple() { copy_from(::roc::move(rhs)); }
+
+            option_tuple& operator=(const option_tuple&) requires (TRIVIALLY_COPYABLE) = default;
+            option_tuple& operator=(const option_tuple& rhs) requires (not TRIVIALLY_COPYABLE)
+            {
+                if (this != &rhs) {
+                    clear();
+                    copy_from(rhs);
+                }
+                return *this;
+            }
+
+            option_tuple& operator=(option_tuple&&) requires (TRIVIALLY_COPYABLE) = default;
+            option_tuple& operator=(option_tuple&& rhs) noexcept(NOTHROW_MOVABLE) requires (not TRIVIALLY_COPYABLE)
+            {
+                if (this != &rhs) {
+                    clear();
+                    copy_from(::roc::move(rhs));
+                }
+                return *this;
+            }
+
+            ~option_tuple() requires (TRIVIALLY_DESTRUCTIBLE) = default;
+            ~option_tuple() requires (not TRIVIALLY_DESTRUCTIBLE) { clear(); }
+
+            template <std::size_t I>
+            bool is_some() const noexcept { return present & mask_of<I>(); }
+
+            template <std::size_t I>
+            bool is_none() const noexcept { return not is_some<I>(); }
+
+            template <std::size_t I>
+            option<element_type<I>&> get() noexcept
+            {
+                if (is_none<I>())
+                    return none_type{};
+                return option<element_type<I>&>{*slot<I>()};
+            }
+
+            template <std::size_t I>
+            option<const element_type<I>&> get() const noexcept
+            {
+                if (is_none<I>())
+                    return none_type{};
+                return option<const element_type<I>&>{*slot<I>()};
+            }
+
+            // Replaces whatever the field held
+            template <std::size_t I, typename... Args>
+            element_type<I>& emplace(Args&&... args)
+            {
+                reset<I>();
+                new (slot<I>()) element_type<I>(::roc::forward<Args>(args)...);
+                present |= mask_of<I>();
+                return *slot<I>();
+            }
+
+            // Assigns to a present field, constructs an absent one
+            template <std::size_t I, typename U>
+            element_type<I>& set(U&& value)
+            {
+                if (is_some<I>()) {
+                    *slot<I>() = ::roc::forward<U>(value);
+                    return *slot<I>();
+                }
+                return emplace<I>(::roc::forward<U>(value));
+            }
+
+            // Moves the value out and leaves the field None
+            template <std::size_t I>
+            option<element_type<I>> take()
+            {
+                if (is_none<I>())
+                    return none_type{};
+
+                option<element_type<I>> taken{::roc::move(*slot<I>())};
+                reset<I>();
+                return taken;
+            }
+
+            template <std::size_t I>
+            void reset() noexcept
+            {
+                if constexpr (not std::is_trivially_destructible<element_type<I>>::value)
+                    if (is_some<I>())
+                        slot<I>()->~element_type<I>();
+                present &= static_cast<mask_type>(~mask_of<I>());
+            }
+
+            void clear() noexcept
+            {
+                if constexpr (not TRIVIALLY_DESTRUCTIBLE)
+                    for_each_field([this](auto index) { reset<decltype(index)::value>(); });
+                present = 0;
+            }
+
+            mask_type present_mask() const noexcept { return present; }
+
+            bool has_all(mask_type required) const noexcept { return (present & required) == required; }
+            bool has_any(mask_type wanted) const noexcept { return (present & wanted) != 0; }
+
+            std::size_t count() const noexcept { return __builtin_popcountll(present); }
+
+        private:
+            template <typename Func>
+            static void for_each_field(Func&& f)
+            {
+                [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                    (f(std::integral_constant<std::size_t, Is>{}), ...);
+                }(std::index_sequence_for<Ts...>{});
+            }
+
+            // Each field is marked present as soon as it's constructed, so a
+            // throwing field leaves the earlier ones to be destroyed
+            template <typename Other>
+            void copy_from(Other&& rhs)
+            {
+                for_each_field([&](auto index) {
+                    constexpr std::size_t I = decltype(index)::value;
+                    if (rhs.template is_some<I>()) {
+                        new (slot<I>()) element_type<I>(::roc::forward<Other>(rhs).template field<I>());
+                        present |= mask_of<I>();
+                    }
+                });
+            }
+
+            template <std::size_t I>
+            element_type<I>* slot() noexcept
+            {
+                return std::launder(reinterpret_cast<element_type<I>*>(storage + layout::LAYOUT.offset[I]));
+            }
+
+            template <std::size_t I>
+            const element_type<I>* slot() const noexcept
+            {
+                return std::launder(reinterpret_cast<const element_type<I>*>(storage + layout::LAYOUT.offset[I]));
+            }
+
+            template <std::size_t I> element_type<I>& field() & noexcept { return *slot<I>(); }
+            template <std::size_t I> const element_type<I>& field() const & noexcept { return *slot<I>(); }
+            template <std::size_t I> element_type<I>&& field() && noexcept { return ::roc::move(*slot<I>()); }
+
+            alignas(layout::ALIGN) unsigned char storage[layout::LAYOUT.size];
+            mask_type present = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef ROC_PTR_RESULT_HPP
+#define ROC_PTR_RESULT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#include "utility.hpp"
+#include "result.hpp"
+
+namespace roc
+{
+    template <typename T, typename E> class ptr_result;
+
+    namespace detail
+    {
+        template <typename E>
+        using error_code_integer = typename std::conditional_t<std::is_enum<E>::value,
+                                                               std::underlying_type<E>,
+                                                               std::type_identity<E>>::type;
+    }
+
+    // result<T*, E> packed into one pointer-sized word.
+    //
+    // T has to be at least 2-byte aligned, so bit 0 of an Ok pointer is always
+    // clear.  An Err sets bit 0 and keeps the code in the upper bits, so E must
+    // be an integer or enum whose values fit in 63 (31) bits, a pointer-sized
+    // code that doesn't throws bad_error_code or panics.  Ok(nullptr) is a
+    // valid Ok.  Ok takes either a pointer or a reference.  There is no room
+    // for an error trace, so errors aren't traced.
+    template <typename T, typename E>
+    class [[nodiscard]] ptr_result
+    {
+        static_assert(alignof(T) >= 2, "ptr_result uses bit 0 of the pointer as the tag, T must be 2-byte aligned");
+        static_assert(std::is_integral<E>::value || std::is_enum<E>::value, "ptr_result error must be an integer or an enum");
+        static_assert(sizeof(E) <= sizeof(std::uintptr_t), "error code must fit in a pointer");
+
+        using code_type = detail::error_code_integer<E>;
+
+        // narrower codes always fit in the bits above the tag
+        constexpr static bool CHECKS_CODE = sizeof(code_type) >= sizeof(std::uintptr_t);
+
+        public:
+            using value_type = T*;
+            using unexpected_type = E;
+
+            constexpr static std::uintptr_t ERR_TAG = 1;
+
+            ptr_result() noexcept = default;
+
+            template <typename U> requires (std::is_convertible<U&&, T*>::value)
+            ptr_result(detail::success_type<U>&& v) noexcept
+                : bits(reinterpret_cast<std::uintptr_t>(static_cast<T*>(::roc::move(v)))) {}
+
+            template <typename U> requires (std::is_lvalue_reference<U>::value
+                                         && std::is_convertible<std::remove_reference_t<U>*, T*>::value)
+            ptr_result(detail::success_type<U>&& v) noexcept
+                : bits(reinterpret_cast<std::uintptr_t>(static_cast<T*>(&static_cast<U>(v)))) {}
+
+            template <typename U> requires (std::is_convertible<U&&, E>::value)
+            ptr_result(detail::error_type<U>&& v) noexcept(not CHECKS_CODE)
+                : bits(encode_error(static_cast<E>(::roc::move(v)))) {}
+
+            static ptr_result from_bits(std::uintptr_t raw) noexcept
+            {
+                ptr_result res;
+                res.bits = raw;
+                return res;
+            }
+            std::uintptr_t to_bits() const noexcept { return bits; }
+
+            [[nodiscard]] bool is_ok() const noexcept { return (bits & ERR_TAG) == 0; }
+            [[nodiscard]] bool is_err() const noexcept { return (bits & ERR_TAG) != 0; }
+
+            [[nodiscard]] bool contains(const T* t) const noexcept { return is_ok() && pointer() == t; }
+            [[nodiscard]] bool contains_err(E e) const noexcept { return is_err() && err_value() == e; }
+
+            T* unwrap() const {
+                if (is_err()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return pointer();
+            }
+
+            E err_value() const {
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access());
+                else return static_cast<E>(static_cast<code_type>(static_cast<std::intptr_t>(bits) >> 1));
+            }
+
+            T* unwrap_or(T* fallback) const noexcept { return is_ok()? pointer() : fallback; }
+
+            template <typename Func>
+            auto and_then(Func&& f) const {
+                using result_type = typename std::invoke_result<Func, value_type>::type;
+                return is_ok()? f(pointer())
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), result_type{detail::error_type<E>(err_value())});
+            }
+
+            // Stays a ptr_result if f gives a suitably aligned pointer
+            template <typename Func>
+            auto map(Func&& f) const {
+                using mapped_type = std::remove_cvref_t<typename std::invoke_result<Func, value_type>::type>;
+                using result_type = std::conditional_t<std::is_pointer<mapped_type>::value
+                                                       && (alignof(std::remove_pointer_t<mapped_type>) >= 2),
+                                                       ptr_result<std::remove_pointer_t<mapped_type>, E>,
+                                                       result<mapped_type, E>>;
+                return is_ok()? result_type{import::Ok(f(pointer()))}
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), result_type{detail::error_type<E>(err_value())});
+            }
+
+            template <typename Func>
+            auto map_err(Func&& f) const {
+                using mapped_error = std::remove_cvref_t<typename std::invoke_result<Func, E>::type>;
+                using result_type = std::conditional_t<std::is_integral<mapped_error>::value || std::is_enum<mapped_error>::value,
+                                                       ptr_result<T, mapped_error>,
+                                                       result<T*, mapped_error>>;
+                return is_ok()? result_type{import::Ok(pointer())}
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), result_type{detail::error_type<typename result_type::unexpected_type>(f(err_value()))});
+            }
+
+            template <typename Func>
+            auto or_else(Func&& f) const {
+                using result_type = typename std::invoke_result<Func, E>::type;
+                return is_ok()? result_type{import::Ok(pointer())}
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), f(err_value()));
+            }
+
+            operator result<T*, E>() const noexcept
+            {
+                if (is_ok())
+                    return result<T*, E>{import::Ok(pointer())};
+                return result<T*, E>{detail::error_type<E>(err_value())};
+            }
+
+        private:
+            // read back with an arithmetic shift, so the code has to survive
+            // losing its top bit
+            static std::uintptr_t encode_error(E e) noexcept(not CHECKS_CODE)
+            {
+                const code_type code = static_cast<code_type>(e);
+                if constexpr (CHECKS_CODE) {
+                    constexpr std::intptr_t max_code = INTPTR_MAX / 2;
+                    constexpr std::intptr_t min_code = INTPTR_MIN / 2;
+                    if constexpr (std::is_signed<code_type>::value) {
+                        if (code > max_code || code < min_code) THROW_OR_PANIC(bad_error_code());
+                    } else {
+                        if (code > static_cast<std::uintptr_t>(max_code)) THROW_OR_PANIC(bad_error_code());
+                    }
+                }
+                return (static_cast<std::uintptr_t>(code) << 1) | ERR_TAG;
+            }
+
+            T* pointer() const noexcept { return reinterpret_cast<T*>(bits); }
+
+            std::uintptr_t bits = 0;
+    };
+
+    // ptr_result behind a single lock-free word
+    template <typename T, typename E>
+    class atomic_ptr_result
+    {
+        using value_type = ptr_result<T, E>;
+
+        public:
+            constexpr static bool is_always_lock_free = std::atomic<std::uintptr_t>::is_always_lock_free;
+
+            atomic_ptr_result() noexcept = default;
+            atomic_ptr_result(value_type initial) noexcept : storage(initial.to_bits()) {}
+
+            atomic_ptr_result(const atomic_ptr_result&) = delete;
+            atomic_ptr_result& operator=(const atomic_ptr_result&) = delete;
+
+            value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+                return value_type::from_bits(storage.load(order));
+            }
+
+            void store(value_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+                storage.store(desired.to_bits(), order);
+            }
+
+            value_type exchange(value_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+                return value_type::from_bits(storage.exchange(desired.to_bits(), order));
+            }
+
+            // On failure, expected is updated with the current contents
+            bool compare_exchange_strong(value_type& expected, value_type desired,
+                                         std::memory_order success = std::memory_order_seq_cst,
+                                         std::memory_order failure = std::memory_order_seq_cst) noexcept
+            {
+                std::uintptr_t current = expected.to_bits();
+                if (storage.compare_exchange_strong(current, desired.to_bits(), success, failure))
+                    return true;
+                expected = value_type::from_bits(current);
+                return false;
+            }
+
+            bool compare_exchange_weak(value_type& expected, value_type desired,
+                                       std::memory_order success = std::memory_order_seq_cst,
+                                       std::memory_order failure = std::memory_order_seq_cst) noexcept
+            {
+                std::uintptr_t current = expected.to_bits();
+                if (storage.compare_exchange_weak(current, desired.to_bits(), success, failure))
+                    return true;
+                expected = value_type::from_bits(current);
+                return false;
+            }
+
+        private:
+            std::atomic<std::uintptr_t> storage {0};
+    };
+}
+
+#endif
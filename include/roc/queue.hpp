@@ -0,0 +1,245 @@
+#ifndef ROC_QUEUE_HPP
+#define ROC_QUEUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "utility.hpp"
+#include "option.hpp"
+#include "result.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+        // Each slot gets its own cache line, so a producer filling one slot
+        // doesn't invalidate the line the consumer is reading next to it.
+        template <typename T>
+        struct alignas(CACHE_LINE_SIZE) queue_slot
+        {
+            queue_slot() noexcept : uninitialised() {}
+            ~queue_slot() {}
+
+            union {
+                T       value;
+                char    uninitialised;
+            };
+        };
+
+        template <typename T>
+        struct alignas(CACHE_LINE_SIZE) sequenced_queue_slot
+        {
+            sequenced_queue_slot() noexcept : uninitialised() {}
+            ~sequenced_queue_slot() {}
+
+            std::atomic<std::size_t> sequence;
+            union {
+                T       value;
+                char    uninitialised;
+            };
+        };
+    }
+
+    // Bounded single-producer single-consumer ring buffer.
+    //
+    // try_pop moves the value out into an option, and try_push hands the value
+    // back in Err when the queue is full.  Each side keeps a cached copy of the
+    // other side's index, so it only touches the shared line when it appears
+    // to be full / empty.
+    template <typename T, std::size_t N>
+    class spsc_queue
+    {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "spsc_queue capacity must be a power of two");
+        static_assert(not std::is_reference<T>::value, "queue cannot hold references");
+
+        public:
+            using value_type = T;
+
+            spsc_queue() noexcept = default;
+            spsc_queue(const spsc_queue&) = delete;
+            spsc_queue& operator=(const spsc_queue&) = delete;
+
+            ~spsc_queue()
+            {
+                if constexpr (not std::is_trivially_destructible<T>::value) {
+                    const std::size_t end = tail.load(std::memory_order_relaxed);
+                    for (std::size_t i = head.load(std::memory_order_relaxed); i != end; ++i)
+                        slots[i & MASK].value.~T();
+                }
+            }
+
+            constexpr static std::size_t capacity() noexcept { return N; }
+
+            result<void, T> try_push(const T& value) { return push(value); }
+            result<void, T> try_push(T&& value) { return push(::roc::move(value)); }
+
+            option<T> try_pop() noexcept(std::is_nothrow_move_constructible<T>::value)
+            {
+                const std::size_t h = head.load(std::memory_order_relaxed);
+                if (h == consumer_tail) {
+                    consumer_tail = tail.load(std::memory_order_acquire);
+                    if (h == consumer_tail)
+                        return none_type{};
+                }
+
+                T& stored = slots[h & MASK].value;
+                option<T> popped{::roc::move(stored)};
+                stored.~T();
+
+                head.store(h + 1, std::memory_order_release);
+                return popped;
+            }
+
+            std::size_t size_approx() const noexcept
+            {
+                return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+            }
+            bool empty() const noexcept { return size_approx() == 0; }
+
+        private:
+            constexpr static std::size_t MASK = N - 1;
+
+            template <typename U>
+            result<void, T> push(U&& value)
+            {
+                const std::size_t t = tail.load(std::memory_order_relaxed);
+                if (t - producer_head == N) {
+                    producer_head = head.load(std::memory_order_acquire);
+                    if (t - producer_head == N)
+                        return import::Err(T(::roc::forward<U>(value)));
+                }
+
+                new (&slots[t & MASK].value) T(::roc::forward<U>(value));
+                tail.store(t + 1, std::memory_order_release);
+                return import::Ok();
+            }
+
+            // consumer side
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<std::size_t> head {0};
+            std::size_t consumer_tail = 0;
+
+            // producer side
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<std::size_t> tail {0};
+            std::size_t producer_head = 0;
+
+            detail::queue_slot<T> slots[N];
+    };
+
+    // Bounded multi-producer multi-consumer queue (Dmitry Vyukov's design).
+    //
+    // Every slot carries a sequence number telling whether it is free for the
+    // producer of a given lap or full for the consumer of it, so producers and
+    // consumers only contend on their own index.  Capacity is rounded up to a
+    // power of two.
+    template <typename T>
+    class mpmc_queue
+    {
+        static_assert(not std::is_reference<T>::value, "queue cannot hold references");
+
+        using slot_type = detail::sequenced_queue_slot<T>;
+
+        public:
+            using value_type = T;
+
+            explicit mpmc_queue(std::size_t capacity)
+                : mask(round_up(capacity) - 1), slots(new slot_type[mask + 1])
+            {
+                for (std::size_t i = 0; i <= mask; ++i)
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            mpmc_queue(const mpmc_queue&) = delete;
+            mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+            ~mpmc_queue()
+            {
+                if constexpr (not std::is_trivially_destructible<T>::value)
+                    while (try_pop().is_some()) {}
+            }
+
+            std::size_t capacity() const noexcept { return mask + 1; }
+
+            result<void, T> try_push(const T& value) { return push(value); }
+            result<void, T> try_push(T&& value) { return push(::roc::move(value)); }
+
+            option<T> try_pop() noexcept(std::is_nothrow_move_constructible<T>::value)
+            {
+                std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+                slot_type* slot;
+
+                for (;;) {
+                    slot = &slots[pos & mask];
+                    const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+
+                    if (diff == 0) {
+                        if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    } else if (diff < 0) {
+                        return none_type{};
+                    } else {
+                        pos = dequeue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+
+                option<T> popped{::roc::move(slot->value)};
+                slot->value.~T();
+
+                slot->sequence.store(pos + mask + 1, std::memory_order_release);
+                return popped;
+            }
+
+            std::size_t size_approx() const noexcept
+            {
+                const std::size_t enqueued = enqueue_pos.load(std::memory_order_acquire);
+                const std::size_t dequeued = dequeue_pos.load(std::memory_order_acquire);
+                return enqueued > dequeued ? enqueued - dequeued : 0;
+            }
+            bool empty() const noexcept { return size_approx() == 0; }
+
+        private:
+            static std::size_t round_up(std::size_t capacity) noexcept
+            {
+                std::size_t size = 2;
+                while (size < capacity)
+                    size <<= 1;
+                return size;
+            }
+
+            template <typename U>
+            result<void, T> push(U&& value)
+            {
+                std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+                slot_type* slot;
+
+                for (;;) {
+                    slot = &slots[pos & mask];
+                    const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+
+                    if (diff == 0) {
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    } else if (diff < 0) {
+                        return import::Err(T(::roc::forward<U>(value)));
+                    } else {
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+
+                new (&slot->value) T(::roc::forward<U>(value));
+                slot->sequence.store(pos + 1, std::memory_order_release);
+                return import::Ok();
+            }
+
+            const std::size_t mask;
+            std::unique_ptr<slot_type[]> slots;
+
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<std::size_t> enqueue_pos {0};
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<std::size_t> dequeue_pos {0};
+    };
+}
+
+#endif
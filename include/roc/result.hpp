@@ -21,11 +21,44 @@ namespace roc {
         bad_result_access() = default;
         const char* what() const noexcept override { return "Bad result access"; } 
     };
+
+    struct bad_error_code : public std::exception
+    {
+        bad_error_code() = default;
+        const char* what() const noexcept override { return "Error code does not fit the packed result"; }
+    };
 }
 #endif
 
 #include "utility.hpp"
 #include "monadic.hpp"
+#include "observed.hpp"
+
+#if defined (ROC_ENABLE_TELEMETRY)
+#include "telemetry.hpp"
+#endif
+#if defined (ROC_ENABLE_USDT) || defined (ROC_ENABLE_ERROR_TRACE)
+#include <source_location>
+#endif
+
+// Marks the error path of a combinator as a propagation point of the trace
+// the error belongs to
+#if defined (ROC_ENABLE_ERROR_TRACE)
+# include "error_trace.hpp"
+# define ROC_TRACE_PROPAGATION(trace) (std::is_constant_evaluated()? void() : ::roc::detail::trace_propagation(trace))
+#else
+# define ROC_TRACE_PROPAGATION(trace) void()
+namespace roc::detail
+{
+    struct trace_handle {};
+
+    struct trace_link
+    {
+        template <typename Wrapped> constexpr void take_trace(const Wrapped&) noexcept {}
+        constexpr trace_handle passed_trace() const noexcept { return {}; }
+    };
+}
+#endif
 
 namespace roc
 {
@@ -35,27 +68,50 @@ namespace roc
         struct error_tag {};
 
         template <typename T, bool Success, bool is_ref = std::is_reference<T>::value>
-        class result_wrap
+        class [[nodiscard]] result_wrap
         {
             public:
                 result_wrap() = delete;
                 result_wrap(const result_wrap&) = delete;
 
                 explicit constexpr result_wrap(result_wrap&&) noexcept;
-                explicit constexpr result_wrap(T v) noexcept : contents(::roc::move(v)) {}
+                // Err starts a trace, combinators pass on the trace of the
+                // error they were given
+                #if defined (ROC_CHECK_OBSERVED)
+                // Err passes the location of its caller
+                explicit constexpr result_wrap(const T& v, trace_handle passed = {},
+                                               const std::source_location& site = std::source_location::current()) noexcept
+                    requires (not std::is_reference<T>::value) : origin(site), trace(passed), contents(v) {}
+                explicit constexpr result_wrap(T&& v, trace_handle passed = {},
+                                               const std::source_location& site = std::source_location::current()) noexcept
+                    : origin(site), trace(passed), contents(::roc::forward<T>(v)) {}
+                #else
+                explicit constexpr result_wrap(const T& v, trace_handle passed = {}) noexcept
+                    requires (not std::is_reference<T>::value) : trace(passed), contents(v) {}
+                explicit constexpr result_wrap(T&& v, trace_handle passed = {}) noexcept
+                    : trace(passed), contents(::roc::forward<T>(v)) {}
+                #endif
 
                 constexpr operator T() const && { return ::roc::move(contents); }
                 constexpr operator T() && { return ::roc::move(contents); }
 
+                // for constructing the result in place, without a temporary
+                constexpr T&& take() && { return ::roc::move(contents); }
+
                 constexpr const T& as_ref() const & { return contents; }
                 constexpr T& as_ref() & { return contents; }
 
+                #if defined (ROC_CHECK_OBSERVED)
+                std::source_location origin;
+                #endif
+                [[no_unique_address]] trace_handle trace;
+
             private:
                 T contents;
         };
 
         template <typename T, bool Success>
-        class result_wrap<T, Success, true>
+        class [[nodiscard]] result_wrap<T, Success, true>
         {
             public:
                 result_wrap() = delete;
@@ -68,6 +124,9 @@ namespace roc
 
                 constexpr operator std::remove_reference_t<T>() && { return ::roc::move(contents); }
 
+                // the referred object is copied, never moved from
+                constexpr T take() && { return contents; }
+
             private:
                 T contents;
         };
@@ -247,6 +306,16 @@ namespace roc
                 this->contains_value = false;
             }
 
+            constexpr void destroy_contents()
+            {
+                if constexpr (not std::is_reference<T>::value && not std::is_trivially_destructible<T>::value)
+                    if (this->contains_value)
+                        this->stored_value.~T();
+                if constexpr (not std::is_trivially_destructible<E>::value)
+                    if (not this->contains_value)
+                        this->stored_error.~E();
+            }
+
             constexpr bool has_value() const { return this->contains_value; }
 
             constexpr T& get() & {
@@ -256,7 +325,7 @@ namespace roc
                     else
                         return this->stored_value;
                 }
-                THROW_OR_PANIC(bad_result_access());
+                THROW_OR_PANIC_UNWRAP(bad_result_access());
             }
             constexpr const T& get() const & {
                 if (this->contains_value) {
@@ -265,7 +334,7 @@ namespace roc
                     else
                         return this->stored_value;
                 }
-                THROW_OR_PANIC(bad_result_access());
+                THROW_OR_PANIC_UNWRAP(bad_result_access());
             }
             constexpr T&& get() && {
                 if (this->contains_value) {
@@ -274,7 +343,7 @@ namespace roc
                     else
                         return ::roc::move(this->stored_value);
                 }
-                THROW_OR_PANIC(bad_result_access());
+                THROW_OR_PANIC_UNWRAP(bad_result_access());
             }
             constexpr const T&& get() const && {
                 if (this->contains_value) {
@@ -284,7 +353,7 @@ namespace roc
                     else
                         return ::roc::move(this->stored_value);
                 }
-                THROW_OR_PANIC(bad_result_access());
+                THROW_OR_PANIC_UNWRAP(bad_result_access());
             }
 
             constexpr E& geterr() & { return this->stored_error; }
@@ -326,7 +395,7 @@ namespace roc
     }
 
     template <typename T, typename E>
-    struct result : detail::result_storage_adds<T, E>
+    struct [[nodiscard]] result : detail::result_storage_adds<T, E>, detail::observation, detail::trace_link
     {
         static_assert(not std::is_reference<E>::value, "error type cannot be a reference");
         public:
@@ -347,7 +416,7 @@ namespace roc
 
             template <typename U> requires (std::is_convertible<U&&, T>::value && (not std::is_reference<T>::value))
             constexpr result(detail::success_type<U>&& v) noexcept(std::is_nothrow_convertible<U&&, T>::value) {
-                this->construct(static_cast<T>(::roc::forward<detail::success_type<U>>(v)));
+                this->construct(::roc::forward<detail::success_type<U>>(v).take());
             }
 
             template <typename U> requires (std::is_reference<T>::value)
@@ -355,42 +424,64 @@ namespace roc
 
             template <typename U> requires (std::is_convertible<U&&, E>::value)
             constexpr result(detail::error_type<U>&& v) noexcept(std::is_nothrow_convertible<U&&, E>::value) {
-                this->construct_error(static_cast<E>(::roc::forward<detail::error_type<U>>(v)));
-            }
-
-            constexpr result& operator=(detail::success_type<T>&& value) noexcept { this->construct(::roc::move(value)); return *this; }
-            constexpr result& operator=(detail::error_type<E>&& error) noexcept { this->construct_error(::roc::move(error)); return *this; };
+                this->take_origin(v);
+                this->take_trace(v);
+                this->construct_error(::roc::forward<detail::error_type<U>>(v).take());
+            }
+
+            #if defined (ROC_CHECK_OBSERVED)
+            constexpr ~result() { this->check_observed(not this->has_value()); }
+            #endif
+
+            constexpr result& operator=(detail::success_type<T>&& value) noexcept {
+                this->destroy_contents();
+                this->construct(::roc::move(value).take());
+                return *this;
+            }
+            constexpr result& operator=(detail::error_type<E>&& error) noexcept {
+                this->destroy_contents();
+                this->take_origin(error);
+                this->take_trace(error);
+                this->construct_error(::roc::move(error).take());
+                return *this;
+            };
 
-            constexpr bool is_ok() const noexcept { return this->has_value(); }
-            constexpr bool is_err() const noexcept { return !this->has_value(); }
+            [[nodiscard]] constexpr bool is_ok() const noexcept { this->observe(); return this->has_value(); }
+            [[nodiscard]] constexpr bool is_err() const noexcept { this->observe(); return !this->has_value(); }
 
-            constexpr bool contains(const std::decay_t<T>& t) const noexcept { return is_ok()? t == unwrap() : false; }
-            constexpr bool contains_err(const E&& e) const noexcept { return is_err()? e == static_cast<E>(this->geterr()) : false; }
+            [[nodiscard]] constexpr bool contains(const std::decay_t<T>& t) const noexcept { return is_ok()? t == unwrap() : false; }
+            [[nodiscard]] constexpr bool contains_err(const E&& e) const noexcept { return is_err()? e == static_cast<E>(this->geterr()) : false; }
 
             constexpr const T& unwrap() const & {
-                if (is_err()) THROW_OR_PANIC(bad_result_access()); else return this->get();
+                if (is_err()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return this->get();
             }
             constexpr T& unwrap() & {
-                if (is_err()) THROW_OR_PANIC(bad_result_access()); else return this->get();
+                if (is_err()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return this->get();
             }
             constexpr const T&& unwrap() const && {
-                if (is_err()) THROW_OR_PANIC(bad_result_access()); else return ::roc::move(this->get());
+                // references are never moved from, the referred object stays put
+                if (is_err()) THROW_OR_PANIC_UNWRAP(bad_result_access());
+                else if constexpr (std::is_reference<T>::value) return this->get();
+                else return ::roc::move(this->get());
             }
             constexpr T&& unwrap() && {
-                if (is_err()) THROW_OR_PANIC(bad_result_access()); else return ::roc::move(this->get());
+                // references are never moved from, the referred object stays put
+                if (is_err()) THROW_OR_PANIC_UNWRAP(bad_result_access());
+                else if constexpr (std::is_reference<T>::value) return this->get();
+                else return ::roc::move(this->get());
             }
 
             constexpr const E& err_value() const & {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return this->geterr();
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return this->geterr();
             }
             constexpr E& err_value() & {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return this->geterr();
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return this->geterr();
             }
             constexpr const E&& err_value() const && {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return ::roc::move(this->geterr());
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return ::roc::move(this->geterr());
             }
             constexpr E&& err_value() && {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return ::roc::move(this->geterr());
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return ::roc::move(this->geterr());
             }
 
             template <typename U> requires (std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value)
@@ -405,32 +496,33 @@ namespace roc
             template <typename Func>
             constexpr auto and_then(Func&& f) {
                 using result_type = typename std::invoke_result<Func, value_type>::type;
-                return is_ok()? f(unwrap()) : result_type{this->geterr()};
+                return is_ok()? f(unwrap())
+                    : (ROC_TRACE_PROPAGATION(this->passed_trace()), result_type{detail::error_type<E>(this->geterr(), this->passed_trace())});
             }
 
             template <typename Func>
             constexpr auto map(Func&& f) {
-                using result_value_type = typename std::invoke_result<Func, value_type>::type::value_type;
-                return is_ok()? result<result_value_type, E>{f(unwrap())}
-                    : result<result_value_type, E>{this->geterr()};
+                using mapped_type = std::remove_cvref_t<typename std::invoke_result<Func, value_type>::type>;
+                return is_ok()? result<mapped_type, E>{detail::success_type<mapped_type>(f(unwrap()))}
+                    : (ROC_TRACE_PROPAGATION(this->passed_trace()), result<mapped_type, E>{detail::error_type<E>(this->geterr(), this->passed_trace())});
             }
 
             template <typename Func>
             constexpr auto map_err(Func&& f) {
-                using result_value_type = typename std::invoke_result<Func, value_type>::type::value_type;
-                return is_ok()? result<result_value_type, E>{unwrap()}
-                    : result<result_value_type, E>{f(this->geterr())};
+                using mapped_error = std::remove_cvref_t<typename std::invoke_result<Func, E&>::type>;
+                return is_ok()? result<T, mapped_error>{detail::success_type<T>(unwrap())}
+                    : (ROC_TRACE_PROPAGATION(this->passed_trace()), result<T, mapped_error>{detail::error_type<mapped_error>(f(this->geterr()), this->passed_trace())});
             }
 
             template <typename Func>
             constexpr auto or_else(Func&& f) {
                 return is_ok()? *this
-                    : result<T, E>{f(this->geterr())};
+                    : (ROC_TRACE_PROPAGATION(this->passed_trace()), result<T, E>{f(this->geterr())});
             }
     };
 
     template <typename E>
-    struct result<void, E> : detail::result_storage_adds<void, E>
+    struct [[nodiscard]] result<void, E> : detail::result_storage_adds<void, E>, detail::observation, detail::trace_link
     {
         public:
             using value_type = void;
@@ -446,30 +538,36 @@ namespace roc
 
             template <typename U> requires (std::is_convertible<U&&, E>::value)
             constexpr result(detail::error_type<U>&& v) noexcept(std::is_nothrow_convertible<U&&, E>::value) {
-                this->construct_error(static_cast<E>(::roc::forward<detail::error_type<U>>(v)));
+                this->take_origin(v);
+                this->take_trace(v);
+                this->construct_error(::roc::forward<detail::error_type<U>>(v).take());
             }
 
-            constexpr bool is_ok() const noexcept { return this->has_value(); }
-            constexpr bool is_err() const noexcept { return !this->has_value(); }
+            #if defined (ROC_CHECK_OBSERVED)
+            constexpr ~result() { this->check_observed(not this->has_value()); }
+            #endif
 
-            constexpr bool contains_err(const E&& e) const noexcept { return is_err()? e == static_cast<E>(this->geterr()) : false; }
+            [[nodiscard]] constexpr bool is_ok() const noexcept { this->observe(); return this->has_value(); }
+            [[nodiscard]] constexpr bool is_err() const noexcept { this->observe(); return !this->has_value(); }
+
+            [[nodiscard]] constexpr bool contains_err(const E&& e) const noexcept { return is_err()? e == static_cast<E>(this->geterr()) : false; }
 
             constexpr const E& err_value() const & {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return this->geterr();
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return this->geterr();
             }
             constexpr E& err_value() & {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return this->geterr();
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return this->geterr();
             }
             constexpr const E&& err_value() const && {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return this->geterr();
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return ::roc::move(this->geterr());
             }
             constexpr E&& err_value() && {
-                if (is_ok()) THROW_OR_PANIC(bad_result_access()); else return this->geterr();
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return ::roc::move(this->geterr());
             }
 
             template <typename Func>
             constexpr auto and_then(Func&& f) {
-                return is_err()? *this : f(valid_void_type{});
+                return is_err()? (ROC_TRACE_PROPAGATION(this->passed_trace()), *this) : f(valid_void_type{});
             }
     };
 
@@ -495,9 +593,34 @@ namespace roc::import
         return detail::success_type<T>(::roc::forward<T>(t));
     }
 
+    #if defined (ROC_ENABLE_TELEMETRY) || defined (ROC_ENABLE_USDT) || defined (ROC_ENABLE_ERROR_TRACE) || defined (ROC_CHECK_OBSERVED)
+    // the site is where Err is written, the default argument is evaluated at
+    // the caller
+    template <typename E> inline constexpr auto Err(E&& e, [[maybe_unused]] const std::source_location& site = std::source_location::current()) {
+        [[maybe_unused]] detail::trace_handle trace {};
+        if (not std::is_constant_evaluated()) {
+            #if defined (ROC_ENABLE_TELEMETRY)
+            telemetry::detail::record(site);
+            #endif
+            #if defined (ROC_ENABLE_USDT)
+            // roc:err(function, file, line), the function signature names E
+            ROC_USDT_PROBE3(roc, err, __PRETTY_FUNCTION__, site.file_name(), site.line());
+            #endif
+            #if defined (ROC_ENABLE_ERROR_TRACE)
+            trace = detail::trace_begin();
+            #endif
+        }
+        #if defined (ROC_CHECK_OBSERVED)
+        return detail::error_type<E>(::roc::forward<E>(e), trace, site);
+        #else
+        return detail::error_type<E>(::roc::forward<E>(e), trace);
+        #endif
+    }
+    #else
     template <typename E> inline constexpr auto Err(E&& e) {
         return detail::error_type<E>(::roc::forward<E>(e));
     }
+    #endif
 
     inline constexpr detail::success_type<void> Ok() {
         return detail::success_type<void>{};
@@ -506,6 +629,118 @@ namespace roc::import
 
 namespace roc
 {
+    namespace detail
+    {
+        template <typename E>
+        concept byte_error_code = (sizeof(E) == 1) && (std::is_integral<E>::value || std::is_enum<E>::value)
+                                  && (not std::is_same<E, bool>::value);
+    }
+
+    // result<bool, E> with a one-byte error code fits in one byte.
+    //
+    // Bytes 0 and 1 are Ok(false) and Ok(true), any other byte is an Err with
+    // the code offset by 2, so codes must be in 0-253.  The value and the error
+    // aren't stored as such, so both are returned by copy.
+    template <typename E> requires detail::byte_error_code<E>
+    struct [[nodiscard]] result<bool, E> : detail::observation, detail::trace_link
+    {
+        public:
+            using value_type = bool;
+            using unexpected_type = E;
+
+            constexpr static unsigned char ERR_OFFSET = 2;
+            constexpr static unsigned char MAX_ERROR_CODE = 0xff - ERR_OFFSET;
+
+            constexpr result() noexcept = default;
+
+            template <typename U> requires (std::is_convertible<U&&, bool>::value)
+            constexpr result(detail::success_type<U>&& v) noexcept
+                : byte(static_cast<bool>(::roc::forward<detail::success_type<U>>(v))) {}
+
+            template <typename U> requires (std::is_convertible<U&&, E>::value)
+            constexpr result(detail::error_type<U>&& v) {
+                this->take_origin(v);
+                this->take_trace(v);
+                byte = encode_error(static_cast<E>(::roc::forward<detail::error_type<U>>(v)));
+            }
+
+            #if defined (ROC_CHECK_OBSERVED)
+            constexpr ~result() { this->check_observed(byte >= ERR_OFFSET); }
+            #endif
+
+            [[nodiscard]] constexpr bool is_ok() const noexcept { this->observe(); return byte < ERR_OFFSET; }
+            [[nodiscard]] constexpr bool is_err() const noexcept { this->observe(); return byte >= ERR_OFFSET; }
+
+            [[nodiscard]] constexpr bool contains(bool t) const noexcept { return is_ok() && static_cast<bool>(byte) == t; }
+            [[nodiscard]] constexpr bool contains_err(E e) const noexcept { return is_err() && err_value() == e; }
+
+            constexpr bool unwrap() const {
+                if (is_err()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return byte != 0;
+            }
+
+            constexpr E err_value() const {
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access());
+                else return static_cast<E>(static_cast<unsigned char>(byte - ERR_OFFSET));
+            }
+
+            constexpr bool unwrap_or(bool fallback) const noexcept { return is_ok()? byte != 0 : fallback; }
+
+            template <typename Func>
+            constexpr auto and_then(Func&& f) const {
+                using result_type = typename std::invoke_result<Func, value_type>::type;
+                return is_ok()? f(byte != 0)
+                    : (ROC_TRACE_PROPAGATION(passed_trace()), result_type{detail::error_type<E>(err_value(), passed_trace())});
+            }
+
+            template <typename Func>
+            constexpr auto map(Func&& f) const {
+                using result_type = result<std::remove_cvref_t<typename std::invoke_result<Func, value_type>::type>, E>;
+                return is_ok()? result_type{import::Ok(f(byte != 0))}
+                    : (ROC_TRACE_PROPAGATION(passed_trace()), result_type{detail::error_type<E>(err_value(), passed_trace())});
+            }
+
+            template <typename Func>
+            constexpr auto map_err(Func&& f) const {
+                using result_type = result<bool, std::remove_cvref_t<typename std::invoke_result<Func, E>::type>>;
+                return is_ok()? result_type{import::Ok(byte != 0)}
+                    : (ROC_TRACE_PROPAGATION(passed_trace()), result_type{detail::error_type<typename result_type::unexpected_type>(f(err_value()), passed_trace())});
+            }
+
+            template <typename Func>
+            constexpr auto or_else(Func&& f) const {
+                using result_type = typename std::invoke_result<Func, E>::type;
+                return is_ok()? result_type{import::Ok(byte != 0)}
+                    : (ROC_TRACE_PROPAGATION(passed_trace()), f(err_value()));
+            }
+
+        private:
+            constexpr static unsigned char encode_error(E e)
+            {
+                const auto code = static_cast<unsigned char>(e);
+                if (code > MAX_ERROR_CODE) THROW_OR_PANIC(bad_error_code());
+                return static_cast<unsigned char>(code + ERR_OFFSET);
+            }
+
+            unsigned char byte = ERR_OFFSET;
+    };
+}
+
+namespace roc
+{
+    // Passes the error of res on, for returning it from a function with a
+    // different Ok type.  res must hold an error.
+    template <typename T, typename E>
+    constexpr detail::error_type<E> propagate(result<T, E>&& res) {
+        const detail::trace_handle trace = res.passed_trace();
+        ROC_TRACE_PROPAGATION(trace);
+        return detail::error_type<E>(::roc::move(res).err_value(), trace);
+    }
+    template <typename T, typename E>
+    constexpr detail::error_type<E> propagate(const result<T, E>& res) {
+        ROC_TRACE_PROPAGATION(res.passed_trace());
+        return detail::error_type<E>(res.err_value(), res.passed_trace());
+    }
+
     template <>
     struct monad_wrap<result>
     {
@@ -0,0 +1,154 @@
+#ifndef ROC_SIGNED_RESULT_HPP
+#define ROC_SIGNED_RESULT_HPP
+
+#include <cerrno>
+#include <type_traits>
+
+#if defined (ROC_ENABLE_EXCEPTIONS)
+#include <exception>
+namespace roc {
+    struct bad_signed_result : public std::exception
+    {
+        bad_signed_result() = default;
+        const char* what() const noexcept override { return "Ok value is negative or Err code is not positive"; }
+    };
+}
+#endif
+
+#include "utility.hpp"
+#include "result.hpp"
+
+namespace roc
+{
+    template <typename T, typename E> struct signed_result;
+
+    namespace detail
+    {
+        template <typename T, typename E>
+        using signed_result_or_result = std::conditional_t<std::is_integral<T>::value && std::is_signed<T>::value,
+                                                           signed_result<T, E>,
+                                                           result<T, E>>;
+    }
+
+    // Result in the syscall convention, one signed word where a negative
+    // value is an error code negated.
+    //
+    // Ok values must be non-negative and Err codes positive (errno values, or
+    // an enum such as std::errc), so is_ok is a sign test.  Values are
+    // returned by copy, the error isn't stored as an E to refer to.  There is
+    // no room for an error trace, so errors aren't traced.
+    template <typename T, typename E = int>
+    struct [[nodiscard]] signed_result
+    {
+        static_assert(std::is_integral<T>::value && std::is_signed<T>::value, "signed_result needs a signed integer");
+        static_assert(std::is_integral<E>::value || std::is_enum<E>::value, "error code must be an integer or an enum");
+
+        public:
+            using value_type = T;
+            using unexpected_type = E;
+
+            constexpr signed_result() noexcept = default;
+
+            template <typename U> requires (std::is_convertible<U&&, T>::value)
+            constexpr signed_result(detail::success_type<U>&& v) : raw(static_cast<T>(::roc::move(v)))
+            {
+                if (raw < 0) THROW_OR_PANIC(bad_signed_result());
+            }
+
+            template <typename U> requires (std::is_convertible<U&&, E>::value)
+            constexpr signed_result(detail::error_type<U>&& v) : raw(-static_cast<T>(static_cast<E>(::roc::move(v))))
+            {
+                if (raw >= 0) THROW_OR_PANIC(bad_signed_result());
+            }
+
+            // The raw return value of a system call, negative is -errno
+            constexpr static signed_result from_raw(T value) noexcept
+            {
+                signed_result res;
+                res.raw = value;
+                return res;
+            }
+
+            // libc convention, -1 and the code in errno
+            static signed_result from_errno(T value) noexcept
+            {
+                return from_raw(value < 0? static_cast<T>(-errno) : value);
+            }
+
+            constexpr T raw_value() const noexcept { return raw; }
+
+            [[nodiscard]] constexpr bool is_ok() const noexcept { return raw >= 0; }
+            [[nodiscard]] constexpr bool is_err() const noexcept { return raw < 0; }
+
+            [[nodiscard]] constexpr bool contains(T t) const noexcept { return is_ok() && raw == t; }
+            [[nodiscard]] constexpr bool contains_err(E e) const noexcept { return is_err() && err_value() == e; }
+
+            constexpr T unwrap() const {
+                if (is_err()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return raw;
+            }
+
+            constexpr E err_value() const {
+                if (is_ok()) THROW_OR_PANIC_UNWRAP(bad_result_access()); else return static_cast<E>(-raw);
+            }
+
+            template <typename U> requires (std::is_convertible<U&&, T>::value)
+            constexpr T unwrap_or(U&& v) const noexcept {
+                return is_ok()? raw : static_cast<T>(::roc::forward<U>(v));
+            }
+
+            template <typename Func>
+            constexpr auto and_then(Func&& f) const {
+                using result_type = typename std::invoke_result<Func, value_type>::type;
+                return is_ok()? f(raw)
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), result_type{detail::error_type<E>(err_value())});
+            }
+
+            // Stays a signed_result if f gives a signed integer
+            template <typename Func>
+            constexpr auto map(Func&& f) const {
+                using mapped_type = std::remove_cvref_t<typename std::invoke_result<Func, value_type>::type>;
+                using result_type = detail::signed_result_or_result<mapped_type, E>;
+                return is_ok()? result_type{import::Ok(f(raw))}
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), result_type{detail::error_type<E>(err_value())});
+            }
+
+            template <typename Func>
+            constexpr auto map_err(Func&& f) const {
+                using mapped_error = std::remove_cvref_t<typename std::invoke_result<Func, E>::type>;
+                using result_type = std::conditional_t<std::is_same<mapped_error, E>::value,
+                                                       signed_result, result<T, mapped_error>>;
+                return is_ok()? result_type{import::Ok(raw)}
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), result_type{detail::error_type<typename result_type::unexpected_type>(f(err_value()))});
+            }
+
+            template <typename Func>
+            constexpr auto or_else(Func&& f) const {
+                using result_type = typename std::invoke_result<Func, E>::type;
+                return is_ok()? result_type{import::Ok(raw)}
+                    : (ROC_TRACE_PROPAGATION(detail::trace_handle{}), f(err_value()));
+            }
+
+            constexpr operator result<T, E>() const noexcept
+            {
+                if (is_ok())
+                    return result<T, E>{import::Ok(raw)};
+                return result<T, E>{detail::error_type<E>(err_value())};
+            }
+
+        private:
+            T raw = 0;
+    };
+
+    #if defined (ROC_ENABLE_STD_STREAMS)
+    template <typename T, typename E>
+    std::ostream& operator<<(std::ostream& stream, const signed_result<T, E>& res) {
+        if (res.is_ok())
+            stream << "Ok(" << res.unwrap() << ")";
+        else
+            stream << "Err(" << static_cast<T>(res.err_value()) << ")";
+        return stream;
+    }
+    #endif
+}
+
+#endif
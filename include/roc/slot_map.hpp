@@ -0,0 +1,196 @@
+#ifndef ROC_SLOT_MAP_HPP
+#define ROC_SLOT_MAP_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "utility.hpp"
+#include "option.hpp"
+
+namespace roc
+{
+    struct slot_handle
+    {
+        std::uint32_t index = ~std::uint32_t{0};
+        std::uint32_t generation = 0;
+
+        constexpr bool operator==(const slot_handle&) const noexcept = default;
+    };
+
+    // Handle-addressed container with dense storage.
+    //
+    // Values are kept contiguous (erase moves the last value into the hole),
+    // and a sparse slot table maps handles to them.  The generation of a slot
+    // is bumped on both insert and erase, so it is odd while the slot is in use,
+    // and stale handles are detected on lookup instead of aliasing a newer
+    // value.  A slot whose generation would wrap around is retired instead of
+    // being reused.
+    template <typename T>
+    class slot_map
+    {
+        static_assert(not std::is_reference<T>::value, "slot_map cannot hold references");
+
+        public:
+            using value_type = T;
+            using handle_type = slot_handle;
+            using iterator = typename std::vector<T>::iterator;
+            using const_iterator = typename std::vector<T>::const_iterator;
+
+            slot_map() = default;
+
+            void reserve(std::size_t count)
+            {
+                values.reserve(count);
+                value_slot.reserve(count);
+                slots.reserve(count);
+            }
+
+            // The value is constructed before a slot is taken, and the
+            // bookkeeping has room reserved, so if the constructor throws the
+            // map is left as it was
+            template <typename... Args>
+            slot_handle emplace(Args&&... args)
+            {
+                reserve_one(value_slot);
+                if (free_head == NO_SLOT)
+                    reserve_one(slots);
+
+                values.emplace_back(::roc::forward<Args>(args)...);
+
+                std::uint32_t index;
+                if (free_head != NO_SLOT) {
+                    index = free_head;
+                    free_head = slots[index].target;
+                } else {
+                    index = static_cast<std::uint32_t>(slots.size());
+                    slots.push_back(slot{NO_SLOT, 0});
+                }
+                slots[index].generation++;
+
+                value_slot.push_back(index);
+                slots[index].target = static_cast<std::uint32_t>(values.size() - 1);
+
+                return slot_handle{index, slots[index].generation};
+            }
+
+            slot_handle insert(const T& value) { return emplace(value); }
+            slot_handle insert(T&& value) { return emplace(::roc::move(value)); }
+
+            bool contains(slot_handle handle) const noexcept { return find(handle) != NO_SLOT; }
+
+            option<T&> get(slot_handle handle) noexcept
+            {
+                const std::uint32_t position = find(handle);
+                if (position == NO_SLOT)
+                    return none_type{};
+                return option<T&>{values[position]};
+            }
+
+            option<const T&> get(slot_handle handle) const noexcept
+            {
+                const std::uint32_t position = find(handle);
+                if (position == NO_SLOT)
+                    return none_type{};
+                return option<const T&>{values[position]};
+            }
+
+            // Moves the value out, None if the handle was stale
+            option<T> erase(slot_handle handle)
+            {
+                const std::uint32_t position = find(handle);
+                if (position == NO_SLOT)
+                    return none_type{};
+
+                option<T> erased{::roc::move(values[position])};
+
+                const std::uint32_t last = static_cast<std::uint32_t>(values.size() - 1);
+                if (position != last) {
+                    values[position] = ::roc::move(values[last]);
+                    value_slot[position] = value_slot[last];
+                    slots[value_slot[position]].target = position;
+                }
+                values.pop_back();
+                value_slot.pop_back();
+
+                release(handle.index);
+                return erased;
+            }
+
+            void clear() noexcept
+            {
+                for (auto index : value_slot)
+                    release(index);
+                values.clear();
+                value_slot.clear();
+            }
+
+            std::size_t size() const noexcept { return values.size(); }
+            bool empty() const noexcept { return values.empty(); }
+
+            // Iteration goes over the dense values, in no particular order
+            iterator begin() noexcept { return values.begin(); }
+            iterator end() noexcept { return values.end(); }
+            const_iterator begin() const noexcept { return values.begin(); }
+            const_iterator end() const noexcept { return values.end(); }
+
+            T* data() noexcept { return values.data(); }
+            const T* data() const noexcept { return values.data(); }
+
+            // Handle of the value at a dense position, for use while iterating
+            slot_handle handle_at(std::size_t position) const noexcept
+            {
+                const std::uint32_t index = value_slot[position];
+                return slot_handle{index, slots[index].generation};
+            }
+
+        private:
+            constexpr static std::uint32_t NO_SLOT = ~std::uint32_t{0};
+
+            // target is the dense position while the slot is in use, and the
+            // next free slot while it is on the free list
+            struct slot
+            {
+                std::uint32_t target;
+                std::uint32_t generation;
+            };
+
+            std::uint32_t find(slot_handle handle) const noexcept
+            {
+                if (handle.index >= slots.size())
+                    return NO_SLOT;
+
+                // even generation is never handed out, so this also rejects free slots
+                const slot& s = slots[handle.index];
+                if (s.generation != handle.generation || (handle.generation & 1) == 0)
+                    return NO_SLOT;
+
+                return s.target;
+            }
+
+            // keeps the growth geometric, reserve(size() + 1) would not
+            template <typename U>
+            static void reserve_one(std::vector<U>& vector)
+            {
+                if (vector.size() == vector.capacity())
+                    vector.reserve(vector.empty()? 4 : vector.size() * 2);
+            }
+
+            void release(std::uint32_t index) noexcept
+            {
+                slot& freed = slots[index];
+                if (++freed.generation != 0) {
+                    freed.target = free_head;
+                    free_head = index;
+                } else {
+                    freed.target = NO_SLOT;
+                }
+            }
+
+            std::vector<T> values;
+            std::vector<std::uint32_t> value_slot;
+            std::vector<slot> slots;
+            std::uint32_t free_head = NO_SLOT;
+    };
+}
+
+#endif
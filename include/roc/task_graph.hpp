@@ -0,0 +1,494 @@
+#ifndef ROC_TASK_GRAPH_HPP
+#define ROC_TASK_GRAPH_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined (ROC_ENABLE_EXCEPTIONS)
+#include <exception>
+namespace roc {
+    struct bad_task_graph_edge : public std::exception
+    {
+        bad_task_graph_edge() = default;
+        const char* what() const noexcept override { return "Task output is already consumed by another node"; }
+    };
+}
+#endif
+
+#include "utility.hpp"
+#include "option.hpp"
+#include "result.hpp"
+
+namespace roc
+{
+    namespace detail
+    {
+        template <typename R, typename E> struct task_result_traits
+        {
+            static_assert(dependent_false<R>(), "task must return roc::result<T, E> with the graph error type");
+        };
+
+        template <typename T, typename E> struct task_result_traits<result<T, E>, E>
+        {
+            using value_type = T;
+        };
+
+        // Chase-Lev work-stealing deque of node indices.  The owning worker pushes
+        // and pops at the bottom, thieves take from the top.
+        //
+        // Every node is pushed at most once per run, so a ring sized to the node
+        // count never overflows, and we don't need the growable buffer.
+        class work_stealing_deque
+        {
+            public:
+                explicit work_stealing_deque(std::size_t capacity)
+                    : mask(round_up(capacity) - 1), buffer(new std::atomic<std::uint32_t>[mask + 1]) {}
+
+                void push(std::uint32_t index) noexcept
+                {
+                    const std::int64_t b = bottom.load(std::memory_order_relaxed);
+                    buffer[b & mask].store(index, std::memory_order_relaxed);
+                    bottom.store(b + 1, std::memory_order_release);
+                }
+
+                option<std::uint32_t> pop() noexcept
+                {
+                    const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+                    bottom.store(b, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    std::int64_t t = top.load(std::memory_order_relaxed);
+
+                    if (t > b) {
+                        bottom.store(b + 1, std::memory_order_relaxed);
+                        return none_type{};
+                    }
+
+                    const std::uint32_t index = buffer[b & mask].load(std::memory_order_relaxed);
+                    if (t == b) {
+                        // last element, race against the thieves for it
+                        const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                                               std::memory_order_relaxed);
+                        bottom.store(b + 1, std::memory_order_relaxed);
+                        if (not won)
+                            return none_type{};
+                    }
+                    return option<std::uint32_t>{index};
+                }
+
+                option<std::uint32_t> steal() noexcept
+                {
+                    std::int64_t t = top.load(std::memory_order_acquire);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    const std::int64_t b = bottom.load(std::memory_order_acquire);
+
+                    if (t >= b)
+                        return none_type{};
+
+                    const std::uint32_t index = buffer[t & mask].load(std::memory_order_relaxed);
+                    if (not top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                                  std::memory_order_relaxed))
+                        return none_type{};
+
+                    return option<std::uint32_t>{index};
+                }
+
+            private:
+                static std::size_t round_up(std::size_t capacity) noexcept
+                {
+                    std::size_t size = 1;
+                    while (size < capacity)
+                        size <<= 1;
+                    return size;
+                }
+
+                alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> top {0};
+                alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> bottom {0};
+                alignas(CACHE_LINE_SIZE) const std::size_t mask;
+                std::unique_ptr<std::atomic<std::uint32_t>[]> buffer;
+        };
+    }
+
+    // DAG of result-returning tasks, executed by a work-stealing pool.
+    //
+    // A task is added with emplace(f, deps...), and f gets the value of every
+    // dependency moved in as T&&.  Because the value is moved, each output can
+    // feed only a single task; additional ordering-only edges are added with
+    // precede().  Edges can only point to existing nodes from emplace, so the
+    // graph stays acyclic unless precede() is used to build a cycle.
+    //
+    // When a task returns Err, none of its transitive dependents are scheduled
+    // and run() returns the first error recorded.  Independent branches still
+    // run to completion.
+    //
+    // The worker threads are started by the first run() and kept for the later
+    // ones, a run with a different thread count restarts them.  Workers that
+    // find nothing to do sleep until a task is pushed or the run ends.
+    template <typename E>
+    class task_graph
+    {
+        static_assert(not std::is_reference<E>::value, "error type cannot be a reference");
+
+        template <typename T> struct value_node;
+
+        public:
+            using error_type = E;
+
+            template <typename T>
+            struct node
+            {
+                using value_type = T;
+                std::uint32_t index;
+            };
+
+            task_graph() = default;
+            task_graph(const task_graph&) = delete;
+            task_graph& operator=(const task_graph&) = delete;
+
+            ~task_graph() { stop_workers(); }
+
+            template <typename Func, typename... Deps>
+            auto emplace(Func&& f, node<Deps>... deps)
+            {
+                using func_type = std::decay_t<Func>;
+                using return_type = std::invoke_result_t<func_type&, Deps&&...>;
+                using value_type = typename detail::task_result_traits<return_type, E>::value_type;
+
+                const auto index = static_cast<std::uint32_t>(nodes.size());
+                nodes.push_back(std::make_unique<task_node<value_type, func_type, Deps...>>(
+                    ::roc::forward<Func>(f), deps.index...));
+
+                (consume(deps.index, index), ...);
+
+                return node<value_type>{index};
+            }
+
+            template <typename T, typename U>
+            void precede(node<T> before, node<U> after)
+            {
+                nodes[before.index]->dependents.push_back(after.index);
+                nodes[after.index]->dependency_count++;
+            }
+
+            // Moves the value out of a finished node.  None if the node didn't run
+            // successfully, or if the value was already passed on to a dependent.
+            template <typename T> requires (not std::is_void<T>::value)
+            option<T> take(node<T> n)
+            {
+                auto& output = static_cast<value_node<T>&>(*nodes[n.index]).output;
+                if (output.is_none())
+                    return none_type{};
+
+                option<T> taken{::roc::move(output.get())};
+                output.reset();
+                return taken;
+            }
+
+            std::size_t size() const noexcept { return nodes.size(); }
+
+            result<void, E> run(unsigned thread_count = std::thread::hardware_concurrency())
+            {
+                if (thread_count == 0)
+                    thread_count = 1;
+
+                failed.store(false, std::memory_order_relaxed);
+                first_error.reset();
+                remaining.store(nodes.size(), std::memory_order_relaxed);
+
+                deques.clear();
+                for (unsigned i = 0; i < thread_count; ++i)
+                    deques.push_back(std::make_unique<detail::work_stealing_deque>(nodes.size()));
+
+                unsigned next = 0;
+                for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+                    nodes[i]->reset();
+                    nodes[i]->pending.store(nodes[i]->dependency_count, std::memory_order_relaxed);
+                    nodes[i]->poisoned.store(false, std::memory_order_relaxed);
+
+                    if (nodes[i]->dependency_count == 0)
+                        deques[next++ % thread_count]->push(i);
+                }
+
+                if (workers.size() != thread_count - 1) {
+                    stop_workers();
+                    workers.reserve(thread_count - 1);
+                    for (unsigned i = 1; i < thread_count; ++i)
+                        workers.emplace_back([this, i] { worker_loop(i); });
+                }
+
+                {
+                    std::lock_guard lock(pool_lock);
+                    busy_workers = thread_count - 1;
+                    run_generation++;
+                }
+                pool_wake.notify_all();
+
+                work(0);
+
+                {
+                    std::unique_lock lock(pool_lock);
+                    pool_done.wait(lock, [this] { return busy_workers == 0; });
+                }
+
+                if (failed.load(std::memory_order_relaxed))
+                    return import::Err(::roc::move(first_error).unwrap());
+
+                return import::Ok();
+            }
+
+        private:
+            struct node_base
+            {
+                virtual ~node_base() = default;
+
+                // returns false if the task returned Err
+                virtual bool execute(task_graph& graph) = 0;
+                virtual void reset() noexcept = 0;
+
+                std::vector<std::uint32_t> dependents;
+                std::uint32_t dependency_count = 0;
+                bool value_consumed = false;
+
+                std::atomic<std::uint32_t> pending {0};
+                std::atomic<bool> poisoned {false};
+            };
+
+            template <typename T>
+            struct value_node : node_base
+            {
+                void reset() noexcept override { output.reset(); }
+
+                option<T> output;
+            };
+
+            template <typename T, typename Func, typename... Deps>
+            struct task_node final : std::conditional_t<std::is_void<T>::value, node_base, value_node<T>>
+            {
+                task_node(Func&& f, decltype(node<Deps>::index)... deps)
+                    : func(::roc::move(f)), inputs{deps...} {}
+                task_node(const Func& f, decltype(node<Deps>::index)... deps)
+                    : func(f), inputs{deps...} {}
+
+                bool execute(task_graph& graph) override
+                {
+                    return execute(graph, std::index_sequence_for<Deps...>{});
+                }
+
+                void reset() noexcept override
+                {
+                    if constexpr (not std::is_void<T>::value)
+                        this->output.reset();
+                }
+
+                template <std::size_t... I>
+                bool execute(task_graph& graph, std::index_sequence<I...>)
+                {
+                    auto res = std::invoke(func, ::roc::move(graph.template output_of<Deps>(inputs[I]))...);
+                    (graph.template release_input<Deps>(inputs[I]), ...);
+
+                    if (res.is_err()) {
+                        graph.record_error(::roc::move(res).err_value());
+                        return false;
+                    }
+
+                    if constexpr (not std::is_void<T>::value)
+                        this->output.construct(::roc::move(res).unwrap());
+
+                    return true;
+                }
+
+                Func func;
+                std::uint32_t inputs[sizeof...(Deps) + 1];
+            };
+
+            template <typename T> T& output_of(std::uint32_t index) noexcept
+            {
+                return static_cast<value_node<T>&>(*nodes[index]).output.get();
+            }
+
+            template <typename T> void release_input(std::uint32_t index) noexcept
+            {
+                static_cast<value_node<T>&>(*nodes[index]).output.reset();
+            }
+
+            void consume(std::uint32_t producer, std::uint32_t consumer)
+            {
+                if (nodes[producer]->value_consumed)
+                    THROW_OR_PANIC(bad_task_graph_edge());
+
+                nodes[producer]->value_consumed = true;
+                nodes[producer]->dependents.push_back(consumer);
+                nodes[consumer]->dependency_count++;
+            }
+
+            void record_error(E&& error)
+            {
+                if (not failed.exchange(true, std::memory_order_acq_rel))
+                    first_error.construct(::roc::move(error));
+            }
+
+            option<std::uint32_t> steal(unsigned self, std::uint32_t& seed) noexcept
+            {
+                const auto count = static_cast<unsigned>(deques.size());
+                if (count == 1)
+                    return none_type{};
+
+                seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+                const unsigned start = seed % count;
+
+                for (unsigned i = 0; i < count; ++i) {
+                    const unsigned victim = (start + i) % count;
+                    if (victim == self)
+                        continue;
+
+                    auto index = deques[victim]->steal();
+                    if (index.is_some())
+                        return index;
+                }
+                return none_type{};
+            }
+
+            // Marks the node done and schedules the dependents it unblocked.  The
+            // dependents of a failed node are poisoned, and poisoned nodes are
+            // retired here without ever being pushed to a deque.
+            void complete(std::uint32_t index, bool succeeded, detail::work_stealing_deque& own)
+            {
+                std::size_t retired = 1;
+                bool pushed = false;
+                std::vector<std::uint32_t> skipped;
+
+                auto release = [&](std::uint32_t released, bool ok) {
+                    for (auto dependent : nodes[released]->dependents) {
+                        auto& target = *nodes[dependent];
+                        if (not ok)
+                            target.poisoned.store(true, std::memory_order_relaxed);
+
+                        if (target.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                            if (target.poisoned.load(std::memory_order_relaxed))
+                                skipped.push_back(dependent);
+                            else {
+                                own.push(dependent);
+                                pushed = true;
+                            }
+                        }
+                    }
+                };
+
+                release(index, succeeded);
+                while (not skipped.empty()) {
+                    const auto next = skipped.back();
+                    skipped.pop_back();
+                    release(next, false);
+                    retired++;
+                }
+
+                // sleeping workers wake up for the new tasks, or to return
+                // when the run is over
+                if (remaining.fetch_sub(retired, std::memory_order_acq_rel) == retired || pushed)
+                    announce_work();
+            }
+
+            void announce_work() noexcept
+            {
+                work_epoch.fetch_add(1, std::memory_order_seq_cst);
+                if (sleepers.load(std::memory_order_seq_cst) != 0)
+                    work_epoch.notify_all();
+            }
+
+            // seen is the epoch from before the last look for work, so anything
+            // pushed since then makes this return at once
+            void wait_for_work(std::uint32_t seen) noexcept
+            {
+                sleepers.fetch_add(1, std::memory_order_seq_cst);
+                if (remaining.load(std::memory_order_seq_cst) != 0)
+                    work_epoch.wait(seen, std::memory_order_seq_cst);
+                sleepers.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void work(unsigned self)
+            {
+                auto& own = *deques[self];
+                std::uint32_t seed = (self + 1) * 0x9e3779b9u;
+                unsigned idle = 0;
+
+                while (remaining.load(std::memory_order_acquire) != 0) {
+                    const std::uint32_t seen = work_epoch.load(std::memory_order_acquire);
+                    auto index = own.pop();
+                    if (index.is_none())
+                        index = steal(self, seed);
+
+                    if (index.is_none()) {
+                        if (++idle > 64) {
+                            wait_for_work(seen);
+                            idle = 0;
+                        }
+                        continue;
+                    }
+
+                    idle = 0;
+                    const auto current = index.unwrap();
+                    complete(current, nodes[current]->execute(*this), own);
+                }
+            }
+
+            // Workers sleep between runs, and count themselves out when done
+            void worker_loop(unsigned self)
+            {
+                std::uint64_t seen = 0;
+                for (;;) {
+                    {
+                        std::unique_lock lock(pool_lock);
+                        pool_wake.wait(lock, [&] { return stopping || run_generation != seen; });
+                        if (stopping)
+                            return;
+                        seen = run_generation;
+                    }
+
+                    work(self);
+
+                    std::lock_guard lock(pool_lock);
+                    if (--busy_workers == 0)
+                        pool_done.notify_one();
+                }
+            }
+
+            void stop_workers() noexcept
+            {
+                {
+                    std::lock_guard lock(pool_lock);
+                    stopping = true;
+                }
+                pool_wake.notify_all();
+
+                for (auto& worker : workers)
+                    worker.join();
+                workers.clear();
+                stopping = false;
+            }
+
+            std::vector<std::unique_ptr<node_base>> nodes;
+            std::vector<std::unique_ptr<detail::work_stealing_deque>> deques;
+
+            std::vector<std::thread> workers;
+            std::mutex pool_lock;
+            std::condition_variable pool_wake;
+            std::condition_variable pool_done;
+            std::uint64_t run_generation = 0;
+            unsigned busy_workers = 0;
+            bool stopping = false;
+
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<std::uint32_t> work_epoch {0};
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<std::uint32_t> sleepers {0};
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<std::size_t> remaining {0};
+            alignas(detail::CACHE_LINE_SIZE) std::atomic<bool> failed {false};
+            option<E> first_error;
+    };
+}
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef ROC_TELEMETRY_HPP
+#define ROC_TELEMETRY_HPP
+
+// Per call site Err counters, compiled in with ROC_ENABLE_TELEMETRY.
+//
+// result.hpp includes this when telemetry is enabled, and import::Err then
+// takes a std::source_location default argument and bumps the counter of its
+// call site.  Needs a hosted standard library.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <source_location>
+#include <vector>
+
+#include "utility.hpp"
+
+namespace roc::telemetry
+{
+    struct site_count
+    {
+        const char*         file;
+        const char*         function;
+        std::uint_least32_t line;
+        std::uint_least32_t column;
+        std::uint64_t       count;
+    };
+
+    namespace detail
+    {
+        // Tables start small and double while at most half full, sites past
+        // the largest table are counted in one overflow entry
+        constexpr static std::size_t INITIAL_SITES_PER_THREAD = 16;
+        constexpr static std::size_t MAX_SITES_PER_THREAD = 1024;
+        constexpr static const char* OVERFLOW_FILE = "(overflow)";
+
+        // Every translation unit has its own copy of the file and function
+        // names, so sites are compared by the text, not the pointers
+        inline int compare_sites(const site_count& lhs, const site_count& rhs) noexcept
+        {
+            if (int order = std::strcmp(lhs.file, rhs.file)) return order;
+            if (lhs.line != rhs.line) return lhs.line < rhs.line? -1 : 1;
+            if (lhs.column != rhs.column) return lhs.column < rhs.column? -1 : 1;
+            return std::strcmp(lhs.function, rhs.function);
+        }
+
+        inline bool same_site(const site_count& lhs, const site_count& rhs) noexcept
+        {
+            return compare_sites(lhs, rhs) == 0;
+        }
+
+        inline bool site_order(const site_count& lhs, const site_count& rhs) noexcept
+        {
+            return compare_sites(lhs, rhs) < 0;
+        }
+
+        // Sums the counts of duplicate sites, leaves them in site order
+        inline void merge_sites(std::vector<site_count>& sites)
+        {
+            std::sort(sites.begin(), sites.end(), site_order);
+
+            std::size_t out = 0;
+            for (std::size_t i = 0; i < sites.size(); ++i) {
+                if (out > 0 && same_site(sites[out - 1], sites[i]))
+                    sites[out - 1].count += sites[i].count;
+                else
+                    sites[out++] = sites[i];
+            }
+            sites.resize(out);
+        }
+
+        // Only the owning thread writes a slot.  file is published last, so a
+        // reader that sees it also sees the rest of the key, and counts are
+        // relaxed load + store, there is no read-modify-write on the hot path.
+        struct site_slot
+        {
+            std::atomic<const char*>    file {nullptr};
+            const char*                 function = nullptr;
+            std::uint_least32_t         line = 0;
+            std::uint_least32_t         column = 0;
+            std::atomic<std::uint64_t>  count {0};
+        };
+
+        struct thread_table;
+
+        struct registry
+        {
+            std::mutex                  lock;
+            thread_table*               head = nullptr;
+            std::vector<site_count>     retired;  // counts of exited threads
+        };
+
+        // never destroyed, threads may still exit after static destructors ran
+        inline registry& global_registry()
+        {
+            static registry* instance = new registry;
+            return *instance;
+        }
+
+        inline void bump(std::atomic<std::uint64_t>& counter) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // Open-addressed by the location.  The lookup compares the name
+        // pointers, which are the same for every call from one translation
+        // unit, a site reached from several gets a slot for each and they are
+        // merged when read.  Only the owning thread grows the slots, under
+        // the registry lock that readers hold.
+        struct alignas(::roc::detail::CACHE_LINE_SIZE) thread_table
+        {
+            site_slot*                  slots = nullptr;
+            std::size_t                 capacity = 0;
+            std::size_t                 used = 0;
+            std::atomic<std::uint64_t>  overflow {0};
+            thread_table*               next = nullptr;
+            thread_table*               prev = nullptr;
+
+            thread_table()
+            {
+                registry& reg = global_registry();
+                std::lock_guard guard(reg.lock);
+                next = reg.head;
+                if (next != nullptr)
+                    next->prev = this;
+                reg.head = this;
+            }
+
+            ~thread_table()
+            {
+                registry& reg = global_registry();
+                std::lock_guard guard(reg.lock);
+                collect(reg.retired);
+                merge_sites(reg.retired);
+                if (prev != nullptr) prev->next = next; else reg.head = next;
+                if (next != nullptr) next->prev = prev;
+                delete[] slots;
+            }
+
+            thread_table(const thread_table&) = delete;
+            thread_table& operator=(const thread_table&) = delete;
+
+            static std::size_t hash_of(const char* file, std::uint_least32_t line, std::uint_least32_t column) noexcept
+            {
+                const std::size_t hash = reinterpret_cast<std::uintptr_t>(file) ^ (std::size_t{line} << 12) ^ column;
+                return hash * 0x9e3779b97f4a7c15ull;
+            }
+
+            void record(const std::source_location& site) noexcept
+            {
+                if (used * 2 >= capacity && capacity < MAX_SITES_PER_THREAD)
+                    grow();
+
+                const char* file = site.file_name();
+                const std::size_t hash = hash_of(file, site.line(), site.column());
+
+                for (std::size_t probe = 0; probe < capacity; ++probe) {
+                    site_slot& slot = slots[(hash + probe) & (capacity - 1)];
+                    const char* owner = slot.file.load(std::memory_order_relaxed);
+
+                    if (owner == file && slot.line == site.line() && slot.column == site.column()
+                        && slot.function == site.function_name()) {
+                        bump(slot.count);
+                        return;
+                    }
+                    if (owner == nullptr) {
+                        slot.function = site.function_name();
+                        slot.line = site.line();
+                        slot.column = site.column();
+                        slot.count.store(1, std::memory_order_relaxed);
+                        slot.file.store(file, std::memory_order_release);
+                        used++;
+                        return;
+                    }
+                }
+                bump(overflow);
+            }
+
+            // Keeps the old slots if the allocation fails
+            void grow() noexcept
+            {
+                const std::size_t grown = capacity == 0? INITIAL_SITES_PER_THREAD : capacity * 2;
+                site_slot* fresh = new (std::nothrow) site_slot[grown];
+                if (fresh == nullptr)
+                    return;
+
+                registry& reg = global_registry();
+                std::lock_guard guard(reg.lock);
+                for (std::size_t i = 0; i < capacity; ++i) {
+                    const site_slot& old = slots[i];
+                    const char* file = old.file.load(std::memory_order_relaxed);
+                    if (file == nullptr)
+                        continue;
+
+                    std::size_t index = hash_of(file, old.line, old.column) & (grown - 1);
+                    while (fresh[index].file.load(std::memory_order_relaxed) != nullptr)
+                        index = (index + 1) & (grown - 1);
+
+                    site_slot& slot = fresh[index];
+                    slot.function = old.function;
+                    slot.line = old.line;
+                    slot.column = old.column;
+                    slot.count.store(old.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    slot.file.store(file, std::memory_order_relaxed);
+                }
+
+                delete[] slots;
+                slots = fresh;
+                capacity = grown;
+            }
+
+            // called with the registry locked
+            void collect(std::vector<site_count>& out) const
+            {
+                for (std::size_t i = 0; i < capacity; ++i) {
+                    const site_slot& slot = slots[i];
+                    const char* file = slot.file.load(std::memory_order_acquire);
+                    if (file != nullptr)
+                        out.push_back({file, slot.function, slot.line, slot.column, slot.count.load(std::memory_order_relaxed)});
+                }
+                if (std::uint64_t dropped = overflow.load(std::memory_order_relaxed))
+                    out.push_back({OVERFLOW_FILE, "", 0, 0, dropped});
+            }
+
+            void reset() noexcept
+            {
+                for (std::size_t i = 0; i < capacity; ++i)
+                    slots[i].count.store(0, std::memory_order_relaxed);
+                overflow.store(0, std::memory_order_relaxed);
+            }
+        };
+
+        inline void record(const std::source_location& site) noexcept
+        {
+            thread_local thread_table table;
+            table.record(site);
+        }
+    }
+
+    // Counts of every site that has created an Err, merged over all threads,
+    // live and exited, most frequent first.  The counts are read without
+    // stopping the threads, so ones that are still running may be a little
+    // behind.
+    inline std::vector<site_count> snapshot()
+    {
+        std::vector<site_count> sites;
+        {
+            detail::registry& reg = detail::global_registry();
+            std::lock_guard guard(reg.lock);
+            sites = reg.retired;
+            for (const detail::thread_table* table = reg.head; table != nullptr; table = table->next)
+                table->collect(sites);
+        }
+
+        detail::merge_sites(sites);
+        std::erase_if(sites, [](const site_count& site) { return site.count == 0; });
+        std::stable_sort(sites.begin(), sites.end(),
+                         [](const site_count& lhs, const site_count& rhs) { return lhs.count > rhs.count; });
+        return sites;
+    }
+
+    // Zeroes all counts.  Increments racing with the reset may survive it.
+    inline void reset()
+    {
+        detail::registry& reg = detail::global_registry();
+        std::lock_guard guard(reg.lock);
+        reg.retired.clear();
+        for (detail::thread_table* table = reg.head; table != nullptr; table = table->next)
+            table->reset();
+    }
+}
+
+#endif
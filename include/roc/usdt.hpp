@@ -0,0 +1,63 @@
+#ifndef ROC_USDT_HPP
+#define ROC_USDT_HPP
+
+// Statically defined tracing probes, the same note format as <sys/sdt.h>, so
+// perf, bpftrace and SystemTap find them as usdt:<binary>:roc:<name>.
+//
+// Each probe is a nop at the probe site plus an entry in the .note.stapsdt
+// section, which tells the tracer where the nop is and where to find the
+// arguments.  There are no semaphores, so the probe site is the same whether
+// anyone is attached or not.  Only implemented for ELF on x86-64 and aarch64,
+// elsewhere the probes are empty.
+
+#include <type_traits>
+
+namespace roc::detail
+{
+    // decays arrays (such as __FILE__) to pointers before they are passed
+    template <typename T>
+    constexpr std::decay_t<T> usdt_arg(T&& value) noexcept { return value; }
+
+    // argument size in the note, negative for signed
+    template <typename T>
+    constexpr int usdt_arg_size = (std::is_signed<T>::value? -1 : 1) * static_cast<int>(sizeof(T));
+}
+
+#if defined (__ELF__) && (defined (__x86_64__) || defined (__aarch64__))
+
+#define ROC_USDT_ARG_SIZE(x) ::roc::detail::usdt_arg_size<decltype(::roc::detail::usdt_arg(x))>
+
+#define ROC_USDT_PROBE3(provider, name, arg1, arg2, arg3)                                           \
+    __asm__ __volatile__ (                                                                          \
+        "990: nop\n"                                                                                \
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                               \
+        ".balign 4\n"                                                                               \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                                          \
+        "991: .asciz \"stapsdt\"\n"                                                                 \
+        "992: .balign 4\n"                                                                          \
+        "993: .8byte 990b\n"                                                                        \
+        ".8byte _.stapsdt.base\n"                                                                   \
+        ".8byte 0\n"                                                                                \
+        ".asciz \"" #provider "\"\n"                                                                \
+        ".asciz \"" #name "\"\n"                                                                    \
+        ".asciz \"%c[s1]@%[a1] %c[s2]@%[a2] %c[s3]@%[a3]\"\n"                                       \
+        "994: .balign 4\n"                                                                          \
+        ".popsection\n"                                                                             \
+        ".ifndef _.stapsdt.base\n"                                                                  \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"                     \
+        ".weak _.stapsdt.base\n"                                                                    \
+        ".hidden _.stapsdt.base\n"                                                                  \
+        "_.stapsdt.base: .space 1\n"                                                                \
+        ".size _.stapsdt.base, 1\n"                                                                 \
+        ".popsection\n"                                                                             \
+        ".endif\n"                                                                                  \
+        :                                                                                           \
+        : [s1] "n"(ROC_USDT_ARG_SIZE(arg1)), [a1] "nor"(::roc::detail::usdt_arg(arg1)),            \
+          [s2] "n"(ROC_USDT_ARG_SIZE(arg2)), [a2] "nor"(::roc::detail::usdt_arg(arg2)),            \
+          [s3] "n"(ROC_USDT_ARG_SIZE(arg3)), [a3] "nor"(::roc::detail::usdt_arg(arg3)))
+
+#else
+# define ROC_USDT_PROBE3(provider, name, arg1, arg2, arg3) ((void)0)
+#endif
+
+#endif
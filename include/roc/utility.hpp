@@ -1,13 +1,27 @@
 #ifndef ROC_UTILITY_HPP
 #define ROC_UTILITY_HPP
 
+#include <cstddef>
 #include <cstdlib> // for abort
 #include <type_traits>
 
 #if defined (ROC_ENABLE_EXCEPTIONS)
-# define THROW_OR_PANIC(x) throw(x)
+# define ROC_RAISE(x) throw(x)
 #else
-# define THROW_OR_PANIC(x) std::abort()
+# define ROC_RAISE(x) std::abort()
+#endif
+
+// Unwrapping the wrong side uses THROW_OR_PANIC_UNWRAP, so it can be traced
+// apart from other panics
+#if defined (ROC_ENABLE_USDT)
+# include "usdt.hpp"
+// roc:panic(expression, file, line), and roc:unwrap(function, file, line)
+// before it, the function signature names the option or result type
+# define THROW_OR_PANIC(x) do { ROC_USDT_PROBE3(roc, panic, #x, __FILE__, __LINE__); ROC_RAISE(x); } while (0)
+# define THROW_OR_PANIC_UNWRAP(x) do { ROC_USDT_PROBE3(roc, unwrap, __PRETTY_FUNCTION__, __FILE__, __LINE__); THROW_OR_PANIC(x); } while (0)
+#else
+# define THROW_OR_PANIC(x) ROC_RAISE(x)
+# define THROW_OR_PANIC_UNWRAP(x) THROW_OR_PANIC(x)
 #endif
 
 namespace roc::tags
@@ -31,6 +45,7 @@ namespace roc
                       "Cannot forward rvalue as an lvalue.");
         return static_cast<T&&>(t);
     }
+    template <typename T> std::add_rvalue_reference_t<T> declval() noexcept; // unevaluated contexts only
 
     template<typename T, typename...> struct dependent_false : std::false_type {};
 
@@ -55,6 +70,10 @@ namespace roc::detail
 
     constexpr static bool TRIVIALLY_DESTRUCTIBLE_ERROR = true;
     constexpr static bool NOT_TRIVIALLY_DESTRUCTIBLE_ERROR = false;
+
+    // Used for padding shared state apart, std::hardware_destructive_interference_size
+    // isn't reliably available
+    constexpr static std::size_t CACHE_LINE_SIZE = 64;
 }
 
 #endif
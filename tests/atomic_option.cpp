@@ -0,0 +1,207 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <roc/atomic_option.hpp>
+
+using namespace roc::import;
+
+namespace {
+    struct small_pair {
+        std::uint16_t a;
+        std::uint16_t b;
+    };
+
+    // one padding byte after tag
+    struct padded {
+        std::uint8_t tag;
+        std::uint16_t value;
+    };
+
+    padded with_padding_bytes(unsigned char fill, std::uint8_t tag, std::uint16_t value)
+    {
+        padded p;
+        std::memset(&p, fill, sizeof(p));
+        p.tag = tag;
+        p.value = value;
+        return p;
+    }
+}
+
+TEST_CASE("roc::atomic_option - traits") {
+    REQUIRE(sizeof(roc::atomic_option<std::uint32_t>) == 8);
+    REQUIRE(sizeof(roc::atomic_option<small_pair>) == 8);
+    REQUIRE(roc::atomic_option<std::uint32_t>::is_always_lock_free);
+    REQUIRE(not std::is_copy_constructible<roc::atomic_option<int>>::value);
+#if defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+    REQUIRE(sizeof(roc::atomic_option<std::uint64_t>) == 16);
+#endif
+}
+
+TEST_CASE("roc::atomic_option - load / store / exchange / take") {
+    roc::atomic_option<int> value;
+    REQUIRE(value.is_none());
+    REQUIRE(value.load().is_none());
+
+    value.store(Some(42));
+    REQUIRE(value.load().contains(42));
+
+    SUBCASE("zero is a value, not None") {
+        value.store(Some(0));
+        REQUIRE(value.is_some());
+        REQUIRE(value.load().contains(0));
+    }
+
+    SUBCASE("exchange returns the previous contents") {
+        REQUIRE(value.exchange(Some(-1)).contains(42));
+        REQUIRE(value.exchange(None).contains(-1));
+        REQUIRE(value.exchange(Some(5)).is_none());
+    }
+
+    SUBCASE("take leaves None") {
+        REQUIRE(value.take().contains(42));
+        REQUIRE(value.take().is_none());
+        REQUIRE(value.is_none());
+    }
+
+    SUBCASE("aggregates") {
+        roc::atomic_option<small_pair> pair { Some(small_pair{1, 2}) };
+        auto loaded = pair.load();
+        REQUIRE(loaded.is_some());
+        REQUIRE(loaded.unwrap().a == 1);
+        REQUIRE(loaded.unwrap().b == 2);
+    }
+}
+
+TEST_CASE("roc::atomic_option - compare_exchange") {
+    roc::atomic_option<int> value;
+
+    roc::option<int> expected = None;
+    REQUIRE(value.compare_exchange_strong(expected, Some(1)));
+    REQUIRE(value.load().contains(1));
+
+    expected = None;
+    REQUIRE(not value.compare_exchange_strong(expected, Some(2)));
+    REQUIRE(expected.contains(1));
+
+    REQUIRE(value.compare_exchange_strong(expected, None));
+    REQUIRE(value.is_none());
+
+    SUBCASE("padding bytes don't take part") {
+        roc::atomic_option<padded> slot { Some(with_padding_bytes(0xaa, 1, 2)) };
+        roc::option<padded> same = Some(with_padding_bytes(0x55, 1, 2));
+        REQUIRE(slot.compare_exchange_strong(same, Some(with_padding_bytes(0x11, 3, 4))));
+        REQUIRE(slot.load().unwrap().value == 4);
+    }
+}
+
+#if defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+TEST_CASE("roc::atomic_option - double width values") {
+    roc::atomic_option<std::uint64_t> value;
+    REQUIRE(value.is_none());
+
+    value.store(Some(std::uint64_t{0}));
+    REQUIRE(value.load().contains(0u));
+
+    roc::option<std::uint64_t> expected = Some(std::uint64_t{0});
+    REQUIRE(value.compare_exchange_strong(expected, Some(~std::uint64_t{0})));
+    REQUIRE(value.take().contains(~std::uint64_t{0}));
+    REQUIRE(value.is_none());
+}
+#endif
+
+TEST_CASE("roc::atomic_option - niche policies keep 8-byte values in one word") {
+    using index_slot = roc::atomic_option<std::uint64_t, roc::sentinel_niche<std::uint64_t, ~std::uint64_t{0}>>;
+    using sample_slot = roc::atomic_option<double, roc::nan_niche<double>>;
+    using pointer_slot = roc::atomic_option<int*, roc::null_niche<int*>>;
+
+    static_assert(sizeof(index_slot) == 8);
+    static_assert(sizeof(sample_slot) == 8);
+    static_assert(sizeof(pointer_slot) == sizeof(void*));
+    static_assert(index_slot::is_always_lock_free == std::atomic<std::uint64_t>::is_always_lock_free);
+    static_assert(std::is_same<decltype(index_slot{}.load()), roc::sentinel_option<std::uint64_t, ~std::uint64_t{0}>>::value);
+
+    SUBCASE("sentinel") {
+        index_slot index;
+        REQUIRE(index.is_none());
+
+        // zero is an ordinary value, None is the sentinel
+        index.store(Some(std::uint64_t{0}));
+        REQUIRE(index.load().contains(0u));
+        REQUIRE(index.take().contains(0u));
+        REQUIRE(index.is_none());
+
+        roc::sentinel_option<std::uint64_t, ~std::uint64_t{0}> expected = None;
+        REQUIRE(index.compare_exchange_strong(expected, Some(std::uint64_t{7})));
+        expected = None;
+        REQUIRE(not index.compare_exchange_strong(expected, Some(std::uint64_t{8})));
+        REQUIRE(expected.contains(7u));
+        REQUIRE(index.exchange(None).contains(7u));
+    }
+
+    SUBCASE("NaN") {
+        sample_slot sample { Some(-0.0) };
+        REQUIRE(sample.load().is_some());
+        sample.store(Some(std::numeric_limits<double>::quiet_NaN()));
+        REQUIRE(sample.is_some());
+        REQUIRE(sample.take().is_some());
+        REQUIRE(sample.is_none());
+    }
+
+    SUBCASE("null") {
+        int target = 3;
+        pointer_slot pointer;
+        REQUIRE(pointer.is_none());
+        pointer.store(Some(&target));
+        REQUIRE(pointer.load().contains(&target));
+        REQUIRE(pointer.take().contains(&target));
+        REQUIRE(pointer.is_none());
+    }
+}
+
+TEST_CASE("roc::atomic_option - every published value is taken exactly once") {
+    constexpr int per_thread = 2000;
+    constexpr int producers = 2;
+
+    roc::atomic_option<int> slot;
+    std::atomic<long> taken_sum {0};
+    std::atomic<int> taken_count {0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 1; i <= per_thread; ++i) {
+                roc::option<int> expected = None;
+                while (not slot.compare_exchange_weak(expected, Some(i * producers + p))) {
+                    expected = None;
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        while (taken_count < per_thread * producers) {
+            auto v = slot.take();
+            if (v.is_some()) {
+                taken_sum += v.unwrap();
+                taken_count++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (auto& t : threads)
+        t.join();
+
+    long expected_sum = 0;
+    for (int p = 0; p < producers; ++p)
+        for (int i = 1; i <= per_thread; ++i)
+            expected_sum += i * producers + p;
+
+    REQUIRE(taken_sum == expected_sum);
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include "doctest.h"
+
+#define ROC_ENABLE_EXCEPTIONS
+
+#include <roc/cache.hpp>
+
+TEST_CASE("cache - capacity 0 is rejected") {
+    using lru = roc::lru_cache<int, int>;
+    using clock = roc::clock_cache<int, int>;
+
+    REQUIRE_THROWS_AS(lru(0), roc::bad_cache_capacity);
+    REQUIRE_THROWS_AS(clock(0), roc::bad_cache_capacity);
+
+    lru smallest(1);
+    smallest.insert_or_assign(1, 10);
+    smallest.insert_or_assign(2, 20);
+    REQUIRE(smallest.size() == 1);
+    REQUIRE(smallest.get(2).unwrap() == 20);
+}
+
+namespace {
+    struct refused {};
+
+    // copies throw while fail is set
+    struct fragile
+    {
+        static inline bool fail = false;
+        static inline int alive = 0;
+
+        explicit fragile(int v) : value(v) { alive++; }
+        fragile(const fragile& other) : value(other.value) { if (fail) throw refused{}; alive++; }
+        fragile& operator=(const fragile&) = default;
+        ~fragile() { alive--; }
+
+        int value;
+
+        bool operator==(const fragile& other) const noexcept { return value == other.value; }
+    };
+
+    struct fragile_hash
+    {
+        std::size_t operator()(const fragile& key) const noexcept { return static_cast<std::size_t>(key.value); }
+    };
+}
+
+TEST_CASE("cache - a throwing value or key leaves the entry free") {
+    SUBCASE("value constructor") {
+        roc::lru_cache<int, fragile> cache(2);
+
+        fragile::fail = true;
+        REQUIRE_THROWS_AS(cache.insert_or_assign(1, fragile{10}), refused);
+        REQUIRE_THROWS_AS((void)cache.get_or_load(2, []() -> roc::result<fragile, int> { throw refused{}; }), refused);
+        fragile::fail = false;
+        REQUIRE(cache.size() == 0);
+        REQUIRE(fragile::alive == 0);
+
+        cache.insert_or_assign(1, fragile{10});
+        cache.insert_or_assign(2, fragile{20});
+        cache.insert_or_assign(3, fragile{30});
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.get(2).unwrap().value == 20);
+        REQUIRE(cache.get(3).unwrap().value == 30);
+    }
+
+    SUBCASE("every entry of a full cache") {
+        roc::clock_cache<int, fragile> cache(1);
+        cache.insert_or_assign(1, fragile{10});
+
+        fragile::fail = true;
+        REQUIRE_THROWS_AS(cache.insert_or_assign(2, fragile{20}), refused);
+        fragile::fail = false;
+        REQUIRE(cache.size() == 0);
+
+        cache.insert_or_assign(3, fragile{30});
+        cache.insert_or_assign(4, fragile{40});
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.get(4).unwrap().value == 40);
+    }
+
+    SUBCASE("key copy") {
+        roc::lru_cache<fragile, int, fragile_hash> cache(1);
+        const fragile key{1};
+
+        fragile::fail = true;
+        REQUIRE_THROWS_AS(cache.insert_or_assign(key, 10), refused);
+        fragile::fail = false;
+        REQUIRE(cache.size() == 0);
+
+        cache.insert_or_assign(key, 10);
+        REQUIRE(cache.get(key).unwrap() == 10);
+    }
+    REQUIRE(fragile::alive == 0);
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <string>
+
+#include <roc/cache.hpp>
+
+using namespace roc::import;
+
+TEST_CASE("roc::lru_cache - get / insert / eviction") {
+    roc::lru_cache<int, std::string> cache(3);
+    REQUIRE(cache.capacity() == 3);
+
+    cache.insert_or_assign(1, "one");
+    cache.insert_or_assign(2, "two");
+    cache.insert_or_assign(3, "three");
+    REQUIRE(cache.size() == 3);
+
+    SUBCASE("get returns a reference into the cache") {
+        cache.get(2).unwrap() += "!";
+        REQUIRE(cache.get(2).unwrap() == "two!");
+        REQUIRE(cache.get(4).is_none());
+
+        REQUIRE(cache.statistics().hits == 2);
+        REQUIRE(cache.statistics().misses == 1);
+    }
+
+    SUBCASE("least recently used entry is evicted") {
+        REQUIRE(cache.get(1).is_some());
+        cache.insert_or_assign(4, "four");
+
+        REQUIRE(cache.size() == 3);
+        REQUIRE(cache.statistics().evictions == 1);
+        REQUIRE(not cache.contains(2));
+        REQUIRE(cache.contains(1));
+        REQUIRE(cache.contains(3));
+        REQUIRE(cache.contains(4));
+    }
+
+    SUBCASE("peek does not refresh the entry") {
+        REQUIRE(cache.peek(1).unwrap() == "one");
+        cache.insert_or_assign(4, "four");
+        REQUIRE(not cache.contains(1));
+        REQUIRE(cache.statistics().hits == 0);
+    }
+
+    SUBCASE("assigning refreshes the entry") {
+        cache.insert_or_assign(1, "uno");
+        cache.insert_or_assign(4, "four");
+        REQUIRE(cache.peek(1).unwrap() == "uno");
+        REQUIRE(not cache.contains(2));
+    }
+
+    SUBCASE("erase moves the value out and frees the entry") {
+        auto erased = cache.erase(2);
+        REQUIRE(erased.unwrap() == "two");
+        REQUIRE(cache.erase(2).is_none());
+        REQUIRE(cache.size() == 2);
+
+        cache.insert_or_assign(4, "four");
+        REQUIRE(cache.statistics().evictions == 0);
+        REQUIRE(cache.size() == 3);
+    }
+}
+
+TEST_CASE("roc::lru_cache - get_or_load") {
+    roc::lru_cache<int, std::string> cache(2);
+    int loads = 0;
+
+    auto load = [&](int key) {
+        return [&, key]() -> roc::result<std::string, int> {
+            loads++;
+            if (key < 0)
+                return Err(key);
+            return Ok(std::to_string(key));
+        };
+    };
+
+    SUBCASE("Ok is cached") {
+        auto first = cache.get_or_load(1, load(1));
+        REQUIRE(first.is_ok());
+        REQUIRE(first.unwrap() == "1");
+
+        auto second = cache.get_or_load(1, load(1));
+        REQUIRE(second.unwrap() == "1");
+        REQUIRE(loads == 1);
+        REQUIRE(cache.statistics().hits == 1);
+        REQUIRE(cache.statistics().misses == 1);
+    }
+
+    SUBCASE("Err is passed through and not cached") {
+        auto first = cache.get_or_load(-1, load(-1));
+        REQUIRE(first.is_err());
+        REQUIRE(first.err_value() == -1);
+        REQUIRE(cache.size() == 0);
+
+        REQUIRE(cache.get_or_load(-1, load(-1)).is_err());
+        REQUIRE(loads == 2);
+    }
+
+    SUBCASE("errors are cached when the cache holds the result type") {
+        roc::lru_cache<int, roc::result<std::string, int>> negative(2);
+
+        auto& first = negative.get_or_load(-1, load(-1));
+        REQUIRE(first.is_err());
+
+        auto& second = negative.get_or_load(-1, load(-1));
+        REQUIRE(&first == &second);
+        REQUIRE(loads == 1);
+
+        REQUIRE(negative.get_or_load(5, load(5)).unwrap() == "5");
+        REQUIRE(negative.size() == 2);
+    }
+}
+
+TEST_CASE("roc::clock_cache - second chance eviction") {
+    roc::clock_cache<int, int> cache(3);
+
+    cache.insert_or_assign(1, 10);
+    cache.insert_or_assign(2, 20);
+    cache.insert_or_assign(3, 30);
+
+    SUBCASE("unreferenced entries go first") {
+        REQUIRE(cache.get(1).unwrap() == 10);
+        REQUIRE(cache.get(3).unwrap() == 30);
+
+        cache.insert_or_assign(4, 40);
+        REQUIRE(not cache.contains(2));
+        REQUIRE(cache.contains(1));
+        REQUIRE(cache.contains(3));
+        REQUIRE(cache.statistics().evictions == 1);
+    }
+
+    SUBCASE("every entry referenced falls back to the hand position") {
+        (void)cache.get(1);
+        (void)cache.get(2);
+        (void)cache.get(3);
+
+        cache.insert_or_assign(4, 40);
+        REQUIRE(not cache.contains(1));
+        REQUIRE(cache.size() == 3);
+    }
+
+    SUBCASE("get_or_load") {
+        auto loaded = cache.get_or_load(7, []() -> roc::result<int, int> { return Ok(70); });
+        REQUIRE(loaded.unwrap() == 70);
+        REQUIRE(cache.peek(7).unwrap() == 70);
+        REQUIRE(cache.size() == 3);
+    }
+
+    SUBCASE("churn keeps the size bounded") {
+        for (int i = 0; i < 1000; ++i) {
+            cache.insert_or_assign(100 + i, i);
+            if (i % 3 == 0)
+                (void)cache.get(100 + i);
+        }
+        REQUIRE(cache.size() == 3);
+        REQUIRE(cache.get(1099).unwrap() == 999);
+    }
+}
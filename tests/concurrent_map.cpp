@@ -0,0 +1,62 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <roc/concurrent_map.hpp>
+
+TEST_CASE("roc::concurrent_map - single threaded") {
+    roc::concurrent_map<int, std::string, 8> map;
+    REQUIRE(map.get(1).is_none());
+
+    REQUIRE(map.insert_or_assign(1, "one"));
+    REQUIRE(not map.insert_or_assign(1, "uno"));
+    REQUIRE(map.get(1).unwrap() == "uno");
+
+    REQUIRE(map.try_emplace(2, "two"));
+    REQUIRE(not map.try_emplace(2, "dos"));
+    REQUIRE(map.get(2).unwrap() == "two");
+    REQUIRE(map.size() == 2);
+
+    REQUIRE(map.update(2, [](std::string& v) { v += "!"; }));
+    REQUIRE(not map.update(3, [](std::string& v) { v += "!"; }));
+    REQUIRE(map.get(2).unwrap() == "two!");
+
+    auto erased = map.erase(1);
+    REQUIRE(erased.unwrap() == "uno");
+    REQUIRE(map.erase(1).is_none());
+    REQUIRE(not map.contains(1));
+
+    map.clear();
+    REQUIRE(map.size() == 0);
+}
+
+TEST_CASE("roc::concurrent_map - concurrent updates") {
+    constexpr int threads = 4;
+    constexpr int keys = 256;
+    constexpr int rounds = 2000;
+
+    roc::concurrent_map<int, long> map;
+    for (int k = 0; k < keys; ++k)
+        map.insert_or_assign(k, 0L);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < rounds; ++i) {
+                const int key = (i * 7 + t) % keys;
+                map.update(key, [](long& v) { v++; });
+                (void)map.get(key);
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+
+    long total = 0;
+    for (int k = 0; k < keys; ++k)
+        total += map.get(k).unwrap();
+    REQUIRE(total == long(threads) * rounds);
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "core_operations.hpp"
+
+// Counts every allocation of the program, malloc through glibc's own entry
+// points and every operator new through malloc, so the test can check that
+// the core operations make none.
+
+namespace {
+    std::atomic<std::size_t> allocations {0};
+
+    template <typename F>
+    std::size_t allocations_in(F&& f)
+    {
+        const std::size_t before = allocations.load();
+        f();
+        return allocations.load() - before;
+    }
+}
+
+#if defined (__GLIBC__)
+extern "C" {
+    void* __libc_malloc(std::size_t size);
+    void* __libc_calloc(std::size_t count, std::size_t size);
+    void* __libc_realloc(void* pointer, std::size_t size);
+    void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+    void* malloc(std::size_t size)
+    {
+        allocations++;
+        return __libc_malloc(size);
+    }
+    void* calloc(std::size_t count, std::size_t size)
+    {
+        allocations++;
+        return __libc_calloc(count, size);
+    }
+    void* realloc(void* pointer, std::size_t size)
+    {
+        allocations++;
+        return __libc_realloc(pointer, size);
+    }
+    void* aligned_alloc(std::size_t alignment, std::size_t size)
+    {
+        allocations++;
+        return __libc_memalign(alignment, size);
+    }
+}
+#endif
+
+void* operator new(std::size_t size)
+{
+    #if not defined (__GLIBC__)
+    allocations++;
+    #endif
+    if (void* pointer = std::malloc(size == 0? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return std::malloc(size == 0? 1 : size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return std::malloc(size == 0? 1 : size); }
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    #if not defined (__GLIBC__)
+    allocations++;
+    #endif
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align))
+        return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+TEST_CASE("roc::option / roc::result - core operations never allocate") {
+    SUBCASE("the counter sees allocations") {
+        REQUIRE(allocations_in([] { int* volatile p = new int(1); delete p; }) == 1);
+        REQUIRE(allocations_in([] { void* volatile p = std::malloc(16); std::free(p); }) == 1);
+    }
+
+    SUBCASE("every operation") {
+        int failed = -1;
+        const volatile int seed = 20;
+        REQUIRE(allocations_in([&] { failed = core_operations::run(seed); }) == 0);
+        REQUIRE(failed == 0);
+    }
+}
@@ -0,0 +1,11 @@
+// Built with -ffreestanding -fno-exceptions -fno-rtti and linked without the
+// C++ standard library, so a header that starts needing libstdc++ (iostreams,
+// operator new, exception or RTTI support) fails to link.  The checks
+// themselves run as a plain program, there is no doctest here.
+
+#include "core_operations.hpp"
+
+int main(int argc, char**)
+{
+    return core_operations::run(argc + 20) == 0? 0 : 1;
+}
@@ -0,0 +1,192 @@
+#ifndef ROC_TEST_CORE_OPERATIONS_HPP
+#define ROC_TEST_CORE_OPERATIONS_HPP
+
+// Every operation of the core headers, with no doctest and nothing hosted,
+// so the same code runs in the freestanding build and under the allocation
+// counter.  seed comes from outside, so nothing folds to a constant.
+
+#include <cstdint>
+
+#include <roc/option.hpp>
+#include <roc/result.hpp>
+#include <roc/signed_result.hpp>
+#include <roc/ptr_result.hpp>
+#include <roc/dyn_error.hpp>
+
+namespace core_operations
+{
+    using namespace roc::import;
+
+    enum class error_code : std::uint8_t { none = 0, bad_input = 1, too_big = 2 };
+
+    struct alignas(8) node
+    {
+        int value;
+    };
+
+    struct io_error
+    {
+        int code;
+        const char* message() const noexcept { return "i/o error"; }
+    };
+
+    struct timeout_error : io_error
+    {
+        using base_error = io_error;
+        unsigned milliseconds;
+    };
+
+    struct check_list
+    {
+        void operator()(bool condition) noexcept { failed += condition? 0 : 1; }
+        int failed = 0;
+    };
+
+    inline roc::result<int, error_code> parse(int seed)
+    {
+        if (seed < 0)
+            return Err(error_code::bad_input);
+        return Ok(seed + 0);
+    }
+
+    inline void options(int seed, check_list& check)
+    {
+        roc::option<int> some = Some(seed + 0);
+        roc::option<int> none = None;
+        check(some.is_some() && none.is_none());
+        check(some.contains(seed));
+        check(some.unwrap() == seed);
+        check(none.unwrap_or(seed + 1) == seed + 1);
+        check(some.map([](int& v) { return v * 2; }).contains(seed * 2));
+        check(none.map([](int& v) { return v * 2; }).is_none());
+        check(some.and_then([](int& v) { return roc::option<long>{v + 1L}; }).contains(seed + 1L));
+
+        roc::option<int> copy = some;
+        copy = none;
+        check(copy.is_none());
+        copy = roc::move(some);
+        check(copy.contains(seed));
+
+        int target = seed;
+        roc::option<int&> ref = Some(target);
+        ref.unwrap()++;
+        check(target == seed + 1);
+        ref.rebind(copy.unwrap());
+        check(ref.contains(seed));
+
+        roc::option<void> empty = Some();
+        check(empty.is_some());
+
+        roc::sentinel_option<int, -1> sentinel = Some(seed + 0);
+        check(sentinel.contains(seed));
+        sentinel = None;
+        check(sentinel.is_none());
+
+        roc::null_option<int*> pointer = Some(&target);
+        check(pointer.is_some() && *pointer.unwrap() == seed + 1);
+        check(sizeof(pointer) == sizeof(int*));
+
+        roc::option<bool> flag = Some(seed > 0);
+        check(flag.is_some() && sizeof(flag) == 1);
+        flag = None;
+        check(flag.is_none());
+
+        roc::nan_option<double> sample = Some(seed * 0.5);
+        check(sample.contains(seed * 0.5));
+    }
+
+    inline void results(int seed, check_list& check)
+    {
+        roc::result<int, error_code> ok = parse(seed);
+        roc::result<int, error_code> err = parse(-1 - seed);
+        check(ok.is_ok() && err.is_err());
+        check(ok.contains(seed));
+        check(err.contains_err(error_code::bad_input));
+        check(ok.unwrap() == seed);
+        check(err.err_value() == error_code::bad_input);
+        check(err.unwrap_or(7) == 7);
+
+        check(ok.map([](const int& v) { return v + 1; }).contains(seed + 1));
+        check(err.map([](const int& v) { return v + 1; }).is_err());
+        check(ok.and_then([](const int& v) { return parse(v + 1); }).contains(seed + 1));
+        check(err.map_err([](error_code& e) { return static_cast<int>(e); }).contains_err(1));
+        check(err.or_else([](error_code&) { return parse(3); }).contains(3));
+        roc::result<long, error_code> passed = roc::propagate(err);
+        check(passed.contains_err(error_code::bad_input));
+
+        roc::result<int, error_code> assigned = ok;
+        assigned = Err(error_code::too_big);
+        check(assigned.is_err());
+        assigned = Ok(seed + 2);
+        check(assigned.contains(seed + 2));
+
+        int target = seed;
+        roc::result<int&, error_code> ref = Ok(target);
+        ref.unwrap()++;
+        check(target == seed + 1);
+
+        roc::result<void, error_code> done = Ok();
+        roc::result<void, error_code> failed = Err(error_code::too_big);
+        check(done.is_ok() && failed.contains_err(error_code::too_big));
+        check(done.and_then([](roc::valid_void_type) { return roc::result<void, error_code>{Ok()}; }).is_ok());
+
+        roc::result<bool, error_code> packed = Ok(seed > 0);
+        check(packed.is_ok() && sizeof(packed) == 1);
+        packed = Err(error_code::too_big);
+        check(packed.contains_err(error_code::too_big));
+    }
+
+    inline void compact_results(int seed, check_list& check)
+    {
+        roc::signed_result<int> read = Ok(seed + 0);
+        roc::signed_result<int> failed = Err(5);
+        check(read.contains(seed) && failed.contains_err(5));
+        check(read.map([](int v) { return v * 2; }).contains(seed * 2));
+        check(failed.or_else([](int) { return roc::signed_result<int>{Ok(0)}; }).contains(0));
+        check(roc::signed_result<int>::from_raw(-4).contains_err(4));
+        roc::result<int, int> widened = failed;
+        check(widened.contains_err(5));
+
+        node n {seed};
+        roc::ptr_result<node, error_code> found = Ok(n);
+        roc::ptr_result<node, error_code> missing = Err(error_code::bad_input);
+        check(found.contains(&n) && missing.contains_err(error_code::bad_input));
+        check(found.map([](node* p) { return p->value; }).contains(seed));
+        check(missing.unwrap_or(&n) == &n);
+        check(sizeof(found) == sizeof(node*));
+    }
+
+    inline roc::result<int, roc::dyn_error> connect(int seed)
+    {
+        if (seed >= 0)
+            return Err(timeout_error{{seed + 0}, 250});
+        return Ok(seed + 0);
+    }
+
+    inline void dyn_errors(int seed, check_list& check)
+    {
+        roc::result<int, roc::dyn_error> failed = connect(seed);
+        check(failed.is_err());
+
+        roc::dyn_error error = failed.err_value();
+        check(error.is<timeout_error>() && error.is<io_error>() && not error.is<node>());
+        check(error.downcast<io_error>().unwrap().code == seed);
+        check(error.downcast<timeout_error>().unwrap().milliseconds == 250);
+        check(error.downcast<node>().is_none());
+        check(error.message()[0] == 'i');
+        check(roc::dyn_error{}.is_empty());
+    }
+
+    // Number of failed checks
+    inline int run(int seed)
+    {
+        check_list check;
+        options(seed, check);
+        results(seed, check);
+        compact_results(seed, check);
+        dyn_errors(seed, check);
+        return check.failed;
+    }
+}
+
+#endif
@@ -0,0 +1,163 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include <roc/dyn_error.hpp>
+#include <roc/result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    struct io_error
+    {
+        int code;
+        const char* message() const noexcept { return "i/o error"; }
+    };
+
+    struct network_error : io_error
+    {
+        using base_error = io_error;
+        std::uint16_t port;
+    };
+
+    struct timeout_error : network_error
+    {
+        using base_error = network_error;
+        std::uint32_t milliseconds;
+        const char* message() const noexcept { return "timed out"; }
+    };
+
+    struct location
+    {
+        const char* file;
+        int line;
+    };
+
+    // io_error isn't the first base, downcasting has to adjust the pointer
+    struct parse_error : location, io_error
+    {
+        using base_error = io_error;
+    };
+
+    struct unrelated_error
+    {
+        char reason;
+    };
+
+    struct too_big_error
+    {
+        char bytes[64];
+    };
+
+    static_assert(std::is_trivially_copyable<roc::dyn_error>::value);
+    static_assert(std::is_trivially_destructible<roc::dyn_error>::value);
+    static_assert(sizeof(roc::dyn_error) == 4 * sizeof(void*));
+    static_assert(roc::dyn_error::FITS<timeout_error>);
+    static_assert(not roc::dyn_error::FITS<too_big_error>);
+    static_assert(not roc::dyn_error::FITS<std::string>);
+    static_assert(roc::basic_dyn_error<64>::FITS<too_big_error>);
+
+    roc::result<int, roc::dyn_error> connect(int attempt)
+    {
+        if (attempt == 0)
+            return Err(timeout_error{{{110}, 443}, 250});
+        if (attempt == 1)
+            return Err(network_error{{111}, 80});
+        if (attempt == 2)
+            return Err(unrelated_error{'x'});
+        return Ok(attempt);
+    }
+}
+
+TEST_CASE("roc::dyn_error - hierarchy") {
+    roc::dyn_error timeout = timeout_error{{{110}, 443}, 250};
+
+    REQUIRE(not timeout.is_empty());
+    REQUIRE(timeout.is<timeout_error>());
+    REQUIRE(timeout.is<network_error>());
+    REQUIRE(timeout.is<io_error>());
+    REQUIRE(timeout.is<const io_error>());
+    REQUIRE(not timeout.is<unrelated_error>());
+    REQUIRE(not timeout.is<parse_error>());
+
+    REQUIRE(timeout.downcast<timeout_error>().unwrap().milliseconds == 250);
+    REQUIRE(timeout.downcast<network_error>().unwrap().port == 443);
+    REQUIRE(timeout.downcast<io_error>().unwrap().code == 110);
+    REQUIRE(timeout.downcast<unrelated_error>().is_none());
+
+    SUBCASE("downcast refers to the stored error") {
+        timeout.downcast<network_error>().unwrap().port = 8080;
+        REQUIRE(timeout.downcast<timeout_error>().unwrap().port == 8080);
+
+        const roc::dyn_error& view = timeout;
+        REQUIRE(view.downcast<io_error>().unwrap().code == 110);
+        static_assert(std::is_same<decltype(view.downcast<io_error>()), roc::option<const io_error&>>::value);
+    }
+
+    SUBCASE("base that isn't first") {
+        roc::dyn_error parse = parse_error{{"config.toml", 12}, {22}};
+        REQUIRE(parse.is<io_error>());
+        REQUIRE(not parse.is<location>());
+        REQUIRE(parse.downcast<io_error>().unwrap().code == 22);
+        REQUIRE(parse.downcast<parse_error>().unwrap().line == 12);
+        REQUIRE(std::strcmp(parse.message(), "i/o error") == 0);
+    }
+
+    SUBCASE("empty") {
+        roc::dyn_error empty;
+        REQUIRE(empty.is_empty());
+        REQUIRE(not empty.is<io_error>());
+        REQUIRE(empty.downcast<io_error>().is_none());
+        REQUIRE(empty.message() == nullptr);
+    }
+}
+
+TEST_CASE("roc::dyn_error - message") {
+    roc::dyn_error timeout = timeout_error{};
+    roc::dyn_error network = network_error{};
+    roc::dyn_error unrelated = unrelated_error{'x'};
+
+    REQUIRE(std::strcmp(timeout.message(), "timed out") == 0);
+    REQUIRE(std::strcmp(network.message(), "i/o error") == 0);
+    REQUIRE(unrelated.message() == nullptr);
+}
+
+TEST_CASE("roc::dyn_error - in a result") {
+    auto timed_out = connect(0);
+    REQUIRE(timed_out.is_err());
+    REQUIRE(timed_out.err_value().is<network_error>());
+    REQUIRE(timed_out.err_value().downcast<timeout_error>().unwrap().milliseconds == 250);
+
+    auto refused = connect(1);
+    REQUIRE(refused.err_value().is<io_error>());
+    REQUIRE(not refused.err_value().is<timeout_error>());
+
+    REQUIRE(not connect(2).err_value().is<io_error>());
+    REQUIRE(connect(3).contains(3));
+
+    SUBCASE("copies carry the error") {
+        roc::result<int, roc::dyn_error> copy = timed_out;
+        roc::dyn_error moved = roc::move(copy).err_value();
+        REQUIRE(moved.downcast<network_error>().unwrap().port == 443);
+    }
+
+    SUBCASE("handled by the nearest matching type") {
+        auto handle = [](const roc::dyn_error& error) {
+            if (error.is<timeout_error>())
+                return 1;
+            if (error.is<network_error>())
+                return 2;
+            if (error.is<io_error>())
+                return 3;
+            return 4;
+        };
+        REQUIRE(handle(connect(0).err_value()) == 1);
+        REQUIRE(handle(connect(1).err_value()) == 2);
+        REQUIRE(handle(roc::dyn_error{parse_error{}}) == 3);
+        REQUIRE(handle(connect(2).err_value()) == 4);
+    }
+}
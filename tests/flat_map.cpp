@@ -0,0 +1,139 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <random>
+
+#include <roc/flat_map.hpp>
+
+TEST_CASE("roc::flat_map - find / try_emplace / erase") {
+    roc::flat_map<std::string, int> map;
+    REQUIRE(map.empty());
+    REQUIRE(map.find("missing").is_none());
+
+    auto inserted = map.try_emplace("one", 1);
+    REQUIRE(inserted.is_ok());
+    REQUIRE(inserted.unwrap() == 1);
+
+    SUBCASE("existing key returns the stored value in Err") {
+        auto existing = map.try_emplace("one", 100);
+        REQUIRE(existing.is_err());
+        int& stored = existing.err_value();
+        REQUIRE(stored == 1);
+        REQUIRE(map.size() == 1);
+    }
+
+    SUBCASE("find returns a reference into the map") {
+        map.find("one").unwrap() = 11;
+        REQUIRE(map.find("one").contains(11));
+
+        const auto& const_map = map;
+        REQUIRE(const_map.find("one").contains(11));
+    }
+
+    SUBCASE("insert_or_assign") {
+        map.insert_or_assign("one", 2);
+        map.insert_or_assign("two", 22);
+        REQUIRE(map.find("one").contains(2));
+        REQUIRE(map.find("two").contains(22));
+        REQUIRE(map.size() == 2);
+    }
+
+    SUBCASE("erase moves the value out") {
+        auto erased = map.erase("one");
+        REQUIRE(erased.contains(1));
+        REQUIRE(map.find("one").is_none());
+        REQUIRE(map.erase("one").is_none());
+        REQUIRE(map.empty());
+    }
+}
+
+namespace {
+    struct fragile
+    {
+        explicit fragile(int v) : value(v) {
+            if (v < 0)
+                throw std::invalid_argument("negative");
+        }
+
+        int value;
+    };
+}
+
+TEST_CASE("roc::flat_map - a throwing value constructor leaves the map unchanged") {
+    roc::flat_map<std::string, fragile> map;
+    for (int i = 0; i < 13; ++i)
+        REQUIRE(map.try_emplace(std::to_string(i), i).is_ok());
+
+    // the 15th insertion of a 16 slot map would fill it past the load
+    REQUIRE_THROWS_AS((void)map.try_emplace("bad", -1), std::invalid_argument);
+    REQUIRE(map.size() == 13);
+    REQUIRE(not map.contains("bad"));
+
+    REQUIRE_THROWS_AS((void)map.try_emplace("worse", -2), std::invalid_argument);
+    REQUIRE(map.try_emplace("good", 7).is_ok());
+    REQUIRE(map.size() == 14);
+
+    std::size_t visited = 0;
+    for (auto [key, value] : map) {
+        REQUIRE(key != "bad");
+        REQUIRE(value.value >= 0);
+        visited++;
+    }
+    REQUIRE(visited == 14);
+    REQUIRE(map.find("12").unwrap().value == 12);
+}
+
+TEST_CASE("roc::flat_map - matches std::unordered_map under churn") {
+    roc::flat_map<std::uint64_t, std::uint64_t> map;
+    std::unordered_map<std::uint64_t, std::uint64_t> reference;
+    std::mt19937_64 rng(1234);
+
+    for (int i = 0; i < 50000; ++i) {
+        const std::uint64_t key = rng() % 2000;
+        switch (rng() % 3) {
+            case 0:
+                map.insert_or_assign(key, i);
+                reference[key] = i;
+                break;
+            case 1:
+                REQUIRE(map.erase(key).is_some() == (reference.erase(key) == 1));
+                break;
+            default: {
+                auto found = map.find(key);
+                auto it = reference.find(key);
+                REQUIRE(found.is_some() == (it != reference.end()));
+                if (found.is_some())
+                    REQUIRE(found.unwrap() == it->second);
+            }
+        }
+    }
+
+    REQUIRE(map.size() == reference.size());
+    REQUIRE(map.load_factor() <= 0.875f);
+
+    std::size_t visited = 0;
+    for (auto [key, value] : map) {
+        REQUIRE(reference.at(key) == value);
+        visited++;
+    }
+    REQUIRE(visited == reference.size());
+}
+
+TEST_CASE("roc::flat_map - scalar and SSE2 control groups agree") {
+    alignas(16) std::int8_t ctrl[16];
+    for (int i = 0; i < 16; ++i)
+        ctrl[i] = static_cast<std::int8_t>(i % 3 == 0? roc::detail::CONTROL_EMPTY : i % 3 == 1? 5 : roc::detail::CONTROL_DELETED);
+
+    roc::detail::control_group<false> scalar(ctrl);
+    REQUIRE(scalar.match(5) == 0b0010010010010010);
+    REQUIRE(scalar.match_empty() == 0b1001001001001001);
+    REQUIRE(scalar.match_empty_or_deleted() == 0b1101101101101101);
+
+    roc::detail::control_group<> native(ctrl);
+    REQUIRE(native.match(5) == scalar.match(5));
+    REQUIRE(native.match_empty() == scalar.match_empty());
+    REQUIRE(native.match_empty_or_deleted() == scalar.match_empty_or_deleted());
+}
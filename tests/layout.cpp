@@ -0,0 +1,126 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include <roc/option.hpp>
+#include <roc/result.hpp>
+
+// Options and results end up in structs shared between processes, so their
+// layout is part of the interface.  Anything that changes a line here changes
+// the layout, update bench/layout_report.cpp output along with it.
+
+using namespace roc::import;
+
+namespace {
+    enum class error_code : std::uint8_t { none, bad_input, too_big };
+
+    struct record
+    {
+        std::uint64_t   id;
+        std::uint8_t    kind;
+    };
+
+    struct alignas(16) vec4
+    {
+        float x, y, z, w;
+    };
+
+    template <typename T, std::size_t Size, std::size_t Align>
+    constexpr bool layout_is = sizeof(T) == Size && alignof(T) == Align;
+
+    // the payload and a presence byte, rounded up to the alignment
+    template <typename T, std::size_t Payload>
+    constexpr bool flagged = sizeof(T) == (Payload + alignof(T)) / alignof(T) * alignof(T);
+
+    template <typename T>
+    constexpr bool trivial = std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value;
+}
+
+TEST_CASE("roc::option - layout") {
+    // None in a niche of the value
+    static_assert(layout_is<roc::option<bool>, 1, 1>);
+    static_assert(layout_is<roc::sentinel_option<std::uint32_t, UINT32_MAX>, 4, 4>);
+    static_assert(layout_is<roc::nan_option<double>, sizeof(double), alignof(double)>);
+    static_assert(layout_is<roc::null_option<int*>, sizeof(int*), alignof(int*)>);
+    static_assert(layout_is<roc::option<int&>, sizeof(int*), alignof(int*)>);
+    static_assert(layout_is<roc::null_option<std::unique_ptr<int>>, sizeof(int*), alignof(int*)>);
+    static_assert(layout_is<roc::option<std::string_view>, sizeof(std::string_view), alignof(std::string_view)>);
+
+    // separate presence flag after the value
+    static_assert(layout_is<roc::option<void>, 1, 1>);
+    static_assert(layout_is<roc::option<char>, 2, 1>);
+    static_assert(layout_is<roc::option<bool, roc::no_niche>, 2, 1>);
+    static_assert(layout_is<roc::option<vec4>, 32, 16>);
+    static_assert(flagged<roc::option<int>, sizeof(int)>);
+    static_assert(flagged<roc::option<double>, sizeof(double)>);
+    static_assert(flagged<roc::option<int*>, sizeof(int*)>);
+    static_assert(flagged<roc::option<std::unique_ptr<int>>, sizeof(int*)>);
+    static_assert(flagged<roc::option<record>, sizeof(record)>);
+    static_assert(flagged<roc::option<std::string>, sizeof(std::string)>);
+
+    static_assert(trivial<roc::option<void>>);
+    static_assert(trivial<roc::option<int>>);
+    static_assert(trivial<roc::option<int&>>);
+    static_assert(trivial<roc::option<record>>);
+    static_assert(trivial<roc::option<vec4>>);
+    static_assert(trivial<roc::option<std::string_view>>);
+    static_assert(not std::is_trivially_copyable<roc::option<std::string>>::value);
+    static_assert(not std::is_trivially_destructible<roc::null_option<std::unique_ptr<int>>>::value);
+
+    #if UINTPTR_MAX == UINT64_MAX
+    static_assert(layout_is<roc::option<int>, 8, 4>);
+    static_assert(layout_is<roc::option<double>, 16, 8>);
+    static_assert(layout_is<roc::option<record>, 24, 8>);
+    #endif
+
+    roc::option<vec4> aligned[2];
+    REQUIRE(reinterpret_cast<std::uintptr_t>(&aligned[1]) % 16 == 0);
+}
+
+TEST_CASE("roc::result - layout") {
+    // Ok(bool) and the error code share one byte
+    static_assert(layout_is<roc::result<bool, error_code>, 1, 1>);
+    static_assert(layout_is<roc::result<bool, std::int8_t>, 1, 1>);
+
+    // union of both sides and a flag
+    static_assert(layout_is<roc::result<void, error_code>, 2, 1>);
+    static_assert(layout_is<roc::result<vec4, error_code>, 32, 16>);
+    static_assert(flagged<roc::result<void, int>, sizeof(int)>);
+    static_assert(flagged<roc::result<bool, int>, sizeof(int)>);
+    static_assert(flagged<roc::result<int, error_code>, sizeof(int)>);
+    static_assert(flagged<roc::result<int, int>, sizeof(int)>);
+    static_assert(flagged<roc::result<double, int>, sizeof(double)>);
+    static_assert(flagged<roc::result<int&, error_code>, sizeof(int*)>);
+    static_assert(flagged<roc::result<record, int>, sizeof(record)>);
+    static_assert(flagged<roc::result<int, std::error_code>, sizeof(std::error_code)>);
+    static_assert(flagged<roc::result<std::string, int>, sizeof(std::string)>);
+    static_assert(flagged<roc::result<int, std::string>, sizeof(std::string)>);
+
+    static_assert(trivial<roc::result<void, error_code>>);
+    static_assert(trivial<roc::result<bool, error_code>>);
+    static_assert(trivial<roc::result<int, int>>);
+    static_assert(trivial<roc::result<int&, int>>);
+    static_assert(trivial<roc::result<record, std::error_code>>);
+    static_assert(trivial<roc::result<vec4, int>>);
+    static_assert(not std::is_trivially_destructible<roc::result<std::string, int>>::value);
+    static_assert(not std::is_trivially_destructible<roc::result<int, std::string>>::value);
+
+    #if UINTPTR_MAX == UINT64_MAX
+    static_assert(layout_is<roc::result<int, int>, 8, 4>);
+    static_assert(layout_is<roc::result<double, error_code>, 16, 8>);
+    static_assert(layout_is<roc::result<int&, int>, 16, 8>);
+    static_assert(layout_is<roc::result<record, int>, 24, 8>);
+    static_assert(layout_is<roc::result<int, std::error_code>, 24, 8>);
+    #endif
+
+    roc::result<vec4, int> aligned[2] = {Ok(vec4{1, 2, 3, 4}), Err(5)};
+    REQUIRE(reinterpret_cast<std::uintptr_t>(&aligned[1]) % 16 == 0);
+    REQUIRE(aligned[0].unwrap().w == 4);
+    REQUIRE(aligned[1].contains_err(5));
+}
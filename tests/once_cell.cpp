@@ -0,0 +1,94 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <roc/once_cell.hpp>
+
+using namespace roc::import;
+
+TEST_CASE("roc::once_cell - get / get_or_init") {
+    roc::once_cell<std::string> cell;
+    REQUIRE(not cell.is_initialised());
+    REQUIRE(cell.get().is_none());
+
+    std::string& value = cell.get_or_init([] { return std::string("first"); });
+    REQUIRE(value == "first");
+    REQUIRE(cell.is_initialised());
+
+    SUBCASE("initialiser runs only once") {
+        std::string& again = cell.get_or_init([] { return std::string("second"); });
+        REQUIRE(&again == &value);
+        REQUIRE(again == "first");
+    }
+
+    SUBCASE("get refers to the stored value") {
+        auto ref = cell.get();
+        REQUIRE(ref.is_some());
+        REQUIRE(&ref.unwrap() == &value);
+    }
+
+    SUBCASE("get_mut modifies the stored value") {
+        roc::once_cell<std::string> empty;
+        REQUIRE(empty.get_mut().is_none());
+
+        cell.get_mut().unwrap() += "!";
+        REQUIRE(&cell.get_mut().unwrap() == &value);
+        REQUIRE(cell.get().unwrap() == "first!");
+    }
+
+    SUBCASE("set on a full cell hands the value back") {
+        auto res = cell.set("third");
+        REQUIRE(res.is_err());
+        REQUIRE(res.err_value() == "third");
+    }
+}
+
+TEST_CASE("roc::once_cell - try_get_or_init leaves the cell empty on Err") {
+    roc::once_cell<int> cell;
+
+    auto failed = cell.try_get_or_init([]() -> roc::result<int, int> { return Err(7); });
+    REQUIRE(failed.is_err());
+    REQUIRE(failed.contains_err(7));
+    REQUIRE(not cell.is_initialised());
+
+    auto retried = cell.try_get_or_init([]() -> roc::result<int, int> { return Ok(42); });
+    REQUIRE(retried.is_ok());
+    REQUIRE(retried.unwrap() == 42);
+    REQUIRE(cell.get().contains(42));
+
+    auto ignored = cell.try_get_or_init([]() -> roc::result<int, int> { return Err(1); });
+    REQUIRE(ignored.is_ok());
+    REQUIRE(ignored.unwrap() == 42);
+}
+
+TEST_CASE("roc::once_cell - racing initialisers") {
+    roc::once_cell<int> cell;
+    std::atomic<int> calls {0};
+    std::atomic<int> sum {0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&, i] {
+            sum += cell.get_or_init([&] { calls++; return i + 100; }) >= 100;
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    REQUIRE(calls == 1);
+    REQUIRE(sum == 8);
+}
+
+TEST_CASE("roc::lazy") {
+    int calls = 0;
+    roc::lazy table([&] { calls++; return std::vector<int>{1, 2, 3}; });
+
+    REQUIRE(not table.is_initialised());
+    REQUIRE(table->size() == 3);
+    REQUIRE((*table)[1] == 2);
+    REQUIRE(calls == 1);
+}
@@ -2,6 +2,7 @@
 #include "doctest.h"
 
 #include <array>
+#include <memory>
 
 #define ROC_ENABLE_EXCEPTIONS
 
@@ -17,3 +18,15 @@ TEST_CASE("option - correct exceptions are thrown") {
     i = Some(42); // just some valid value
     REQUIRE(i.unwrap());
 }
+
+TEST_CASE("null_option - Some(nullptr) is rejected") {
+    using roc::import::Some;
+
+    REQUIRE_THROWS_AS(roc::null_option<int*>{static_cast<int*>(nullptr)}, roc::bad_option_value);
+    REQUIRE_THROWS_AS(roc::null_option<std::unique_ptr<int>>{std::unique_ptr<int>{}}, roc::bad_option_value);
+
+    int value = 1;
+    roc::null_option<int*> pointer{&value};
+    REQUIRE_THROWS_AS(pointer = Some(static_cast<int*>(nullptr)), roc::bad_option_value);
+    REQUIRE(pointer.contains(&value));
+}
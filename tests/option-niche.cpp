@@ -0,0 +1,324 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <roc/option.hpp>
+
+using namespace roc::import;
+
+namespace {
+    using index_option = roc::sentinel_option<std::uint32_t, UINT32_MAX>;
+
+    static_assert(sizeof(index_option) == sizeof(std::uint32_t));
+    static_assert(std::is_trivially_copyable<index_option>::value);
+    static_assert(std::is_trivially_destructible<index_option>::value);
+
+    constexpr index_option constant_some{7u};
+    constexpr index_option constant_none{None};
+    static_assert(constant_some.is_some() && constant_some.unwrap() == 7u);
+    static_assert(constant_none.is_none() && constant_none.unwrap_or(3u) == 3u);
+
+    // generic code written against option
+    template <typename T, typename P>
+    T sum_present(const std::vector<roc::option<T, P>>& values)
+    {
+        T sum = 0;
+        for (const auto& v : values)
+            sum += v.unwrap_or(T{0});
+        return sum;
+    }
+}
+
+TEST_CASE("roc::sentinel_option - basic interface") {
+    index_option some{5u};
+    index_option none = None;
+    index_option defaulted;
+
+    REQUIRE(some.is_some());
+    REQUIRE(some.unwrap() == 5u);
+    REQUIRE(some.contains(5u));
+    REQUIRE(none.is_none());
+    REQUIRE(defaulted.is_none());
+    REQUIRE(none.unwrap_or(9u) == 9u);
+
+    SUBCASE("converts from Some") {
+        std::uint32_t value = 11;
+        index_option from_lvalue = Some(value);
+        index_option from_rvalue = Some(12u);
+        REQUIRE(from_lvalue.unwrap() == 11u);
+        REQUIRE(from_rvalue.unwrap() == 12u);
+
+        index_option assigned;
+        assigned = Some(13u);
+        REQUIRE(assigned.unwrap() == 13u);
+        assigned = None;
+        REQUIRE(assigned.is_none());
+    }
+
+    SUBCASE("and_then / map") {
+        auto doubled = some.map([](std::uint32_t v) { return v * 2; });
+        REQUIRE(doubled.unwrap() == 10u);
+        REQUIRE(none.map([](std::uint32_t v) { return v * 2; }).is_none());
+
+        auto chained = some.and_then([](std::uint32_t v) { return index_option{v + 1}; });
+        REQUIRE(chained.unwrap() == 6u);
+        REQUIRE(none.and_then([](std::uint32_t v) { return index_option{v + 1}; }).is_none());
+    }
+
+    SUBCASE("storing the sentinel reads back as None") {
+        index_option sentinel{UINT32_MAX};
+        REQUIRE(sentinel.is_none());
+    }
+
+    SUBCASE("works in generic option code") {
+        std::vector<index_option> packed{index_option{1u}, None, index_option{4u}};
+        std::vector<roc::option<std::uint32_t>> plain{roc::option<std::uint32_t>{1u}, None, roc::option<std::uint32_t>{4u}};
+        REQUIRE(sum_present(packed) == 5u);
+        REQUIRE(sum_present(plain) == 5u);
+    }
+}
+
+TEST_CASE("roc::sentinel_option - signed sentinel") {
+    using offset_option = roc::sentinel_option<int, -1>;
+    static_assert(sizeof(offset_option) == sizeof(int));
+
+    offset_option zero{0};
+    REQUIRE(zero.is_some());
+    REQUIRE(zero.unwrap() == 0);
+    REQUIRE(offset_option{-1}.is_none());
+}
+
+TEST_CASE("roc::nan_option - None is a reserved NaN") {
+    using sample = roc::nan_option<double>;
+    using sample_f = roc::nan_option<float>;
+
+    static_assert(sizeof(sample) == sizeof(double));
+    static_assert(sizeof(sample_f) == sizeof(float));
+    static_assert(std::is_trivially_copyable<sample>::value);
+    static_assert(sample{}.is_none());
+    static_assert(sample{1.5}.unwrap() == 1.5);
+
+    sample some{2.5};
+    sample none = None;
+    REQUIRE(some.unwrap() == 2.5);
+    REQUIRE(none.is_none());
+    REQUIRE(none.unwrap_or(-1.0) == -1.0);
+    REQUIRE(some.map([](double v) { return v * 2; }).unwrap() == 5.0);
+
+    SUBCASE("NaNs from user arithmetic are Some") {
+        volatile double zero = 0.0;
+        volatile double inf = std::numeric_limits<double>::infinity();
+        volatile double minus_one = -1.0;
+
+        const double nans[] = {
+            zero / zero,
+            inf - inf,
+            zero * inf,
+            std::sqrt(minus_one),
+            std::log(minus_one),
+            -(zero / zero),
+            std::nan(""),
+            std::nan("1"),
+            std::nan("1313818181"),
+            std::numeric_limits<double>::quiet_NaN(),
+            std::numeric_limits<double>::signaling_NaN(),
+        };
+
+        for (double nan : nans) {
+            REQUIRE(std::isnan(nan));
+            sample boxed{nan};
+            REQUIRE(boxed.is_some());
+            REQUIRE(std::isnan(boxed.unwrap()));
+
+            // and the NaN survives a round trip through arithmetic
+            sample computed{boxed.unwrap() + 1.0};
+            REQUIRE(computed.is_some());
+        }
+    }
+
+    SUBCASE("float NaNs are Some") {
+        volatile float zero = 0.0f;
+        const float nans[] = {
+            zero / zero,
+            std::sqrt(-zero - 1.0f),
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::signaling_NaN(),
+            std::nanf("20047"),
+        };
+
+        for (float nan : nans)
+            REQUIRE(sample_f{nan}.is_some());
+        REQUIRE(sample_f{}.is_none());
+    }
+
+    SUBCASE("every other payload is Some") {
+        const auto none_bits = roc::nan_niche<double>::NONE_BITS;
+        for (unsigned long long delta = 1; delta < (1ull << 20); delta <<= 1) {
+            unsigned long long bits = none_bits ^ delta;
+            double value;
+            std::memcpy(&value, &bits, sizeof value);
+            REQUIRE(sample{value}.is_some());
+        }
+    }
+
+    SUBCASE("only the reserved payload is None") {
+        REQUIRE(sample{roc::nan_niche<double>::none()}.is_none());
+        REQUIRE(sample_f{roc::nan_niche<float>::none()}.is_none());
+    }
+
+    SUBCASE("infinities and signed zeroes are Some") {
+        REQUIRE(sample{std::numeric_limits<double>::infinity()}.is_some());
+        REQUIRE(sample{-std::numeric_limits<double>::infinity()}.is_some());
+        REQUIRE(sample{0.0}.is_some());
+        REQUIRE(sample{-0.0}.is_some());
+    }
+}
+
+TEST_CASE("roc::option - null pointer niche") {
+    static_assert(sizeof(roc::null_option<int*>) == sizeof(int*));
+    static_assert(sizeof(roc::null_option<const char*>) == sizeof(const char*));
+    static_assert(sizeof(roc::null_option<std::unique_ptr<int>>) == sizeof(int*));
+    static_assert(sizeof(roc::null_option<std::unique_ptr<int[]>>) == sizeof(int*));
+    static_assert(sizeof(roc::option<std::string_view>) == sizeof(std::string_view));
+    static_assert(sizeof(roc::option<std::span<int>>) == sizeof(std::span<int>));
+    static_assert(std::is_trivially_copyable<roc::null_option<int*>>::value);
+    static_assert(std::is_trivially_copyable<roc::option<std::string_view>>::value);
+
+    // pointers only use the niche when asked, fixed extent spans and owning
+    // strings keep the flag
+    static_assert(sizeof(roc::option<int*>) > sizeof(int*));
+    static_assert(sizeof(roc::option<std::unique_ptr<int>>) > sizeof(int*));
+    static_assert(sizeof(roc::option<std::span<int, 4>>) > sizeof(std::span<int, 4>));
+    static_assert(sizeof(roc::option<std::string>) > sizeof(std::string));
+
+    static_assert(roc::option<std::string_view>{}.is_none());
+    static_assert(roc::option<std::string_view>{std::string_view{}}.is_some());
+    static_assert(roc::option<std::string_view>{std::string_view{"word"}}.unwrap() == "word");
+    constexpr roc::option<std::string_view> constant{};
+    static_assert(constant.is_none());
+
+    static constexpr int target = 1;
+    static_assert(roc::null_option<const int*>{&target}.contains(&target));
+    static_assert(roc::null_option<const int*>{}.is_none());
+
+    SUBCASE("raw pointers") {
+        int value = 5;
+        roc::null_option<int*> some{&value};
+        roc::null_option<int*> none = None;
+        REQUIRE(*some.unwrap() == 5);
+        REQUIRE(none.is_none());
+
+        // null is a valid Some only without the niche, null_option rejects
+        // it (tests/option-exceptions.cpp)
+        REQUIRE(roc::option<int*>{static_cast<int*>(nullptr)}.is_some());
+        REQUIRE(Some(static_cast<int*>(nullptr)).is_some());
+        REQUIRE(Some(static_cast<int*>(nullptr)).unwrap() == nullptr);
+    }
+
+    SUBCASE("unique_ptr") {
+        roc::null_option<std::unique_ptr<int>> owned{std::make_unique<int>(7)};
+        REQUIRE(owned.is_some());
+        REQUIRE(*owned.unwrap() == 7);
+
+        auto moved = roc::move(owned);
+        REQUIRE(*moved.unwrap() == 7);
+        REQUIRE(owned.is_none());
+
+        moved = None;
+        REQUIRE(moved.is_none());
+
+        auto taken = roc::null_option<std::unique_ptr<int>>{std::make_unique<int>(8)};
+        std::unique_ptr<int> out = roc::move(taken).unwrap();
+        REQUIRE(*out == 8);
+    }
+
+    SUBCASE("string_view and span") {
+        using namespace std::literals;
+        roc::option<std::string_view> word{"word"sv};
+        roc::option<std::string_view> empty{""sv};
+        roc::option<std::string_view> defaulted{std::string_view{}};
+        roc::option<std::string_view> none = None;
+
+        REQUIRE(word.unwrap() == "word");
+        REQUIRE(empty.is_some());
+        REQUIRE(defaulted.is_some());
+        REQUIRE(defaulted.unwrap().empty());
+        REQUIRE(none.is_none());
+        REQUIRE(none.unwrap_or("fallback"sv) == "fallback");
+        REQUIRE(roc::option<std::string_view>{}.is_none());
+
+        // copies carry None over
+        roc::option<std::string_view> copy = none;
+        REQUIRE(copy.is_none());
+        copy = word;
+        REQUIRE(copy.unwrap() == "word");
+        copy = None;
+        REQUIRE(copy.is_none());
+
+        int values[] = {1, 2, 3};
+        roc::option<std::span<int>> view{std::span<int>(values)};
+        REQUIRE(view.unwrap().size() == 3);
+        REQUIRE(roc::option<std::span<int>>{std::span<int>{}}.is_some());
+        REQUIRE(roc::option<std::span<int>>{}.is_none());
+    }
+}
+
+TEST_CASE("roc::option - bool is one byte") {
+    static_assert(sizeof(roc::option<bool>) == 1);
+    static_assert(sizeof(roc::option<bool, roc::no_niche>) == 2);
+    static_assert(std::is_trivially_copyable<roc::option<bool>>::value);
+
+    static_assert(roc::option<bool>{}.is_none());
+    static_assert(roc::option<bool>{true}.contains(true));
+    static_assert(roc::option<bool>{false}.contains(false));
+    constexpr roc::option<bool> constant{};
+    static_assert(constant.is_none());
+    static_assert([] {
+        roc::option<bool> flag{true};
+        flag = None;
+        roc::option<bool> copied = flag;
+        return copied.is_none();
+    }());
+
+    roc::option<bool> yes{true};
+    roc::option<bool> no{false};
+    roc::option<bool> none = None;
+    roc::option<bool> defaulted;
+
+    REQUIRE(yes.contains(true));
+    REQUIRE(no.is_some());
+    REQUIRE(not no.unwrap());
+    REQUIRE(none.is_none());
+    REQUIRE(defaulted.is_none());
+    REQUIRE(none.unwrap_or(true));
+
+    SUBCASE("copies keep None") {
+        roc::option<bool> copied = none;
+        REQUIRE(copied.is_none());
+
+        std::vector<roc::option<bool>> flags{yes, none, no};
+        auto moved = roc::move(flags);
+        REQUIRE(moved[0].unwrap());
+        REQUIRE(moved[1].is_none());
+        REQUIRE(moved[2].contains(false));
+    }
+
+    SUBCASE("assignment and reset") {
+        roc::option<bool> flag;
+        flag = Some(false);
+        REQUIRE(flag.contains(false));
+        flag = None;
+        REQUIRE(flag.is_none());
+        flag = Some(true);
+        REQUIRE(flag.contains(true));
+    }
+}
@@ -2,6 +2,7 @@
 #include "doctest.h"
 
 #include <roc/option.hpp>
+#include "test_types.hpp"
 
 TEST_CASE("Triviality") {
     REQUIRE(std::is_trivially_copy_constructible<roc::option<int>>::value);
@@ -176,3 +177,87 @@ TEST_CASE("Option gets valid values from Some()") {
 TEST_CASE("Option gets valid values from None") {
     using roc::import::None;
 }
+
+TEST_CASE("Option operation counts") {
+    using roc::import::Some;
+    using roc::import::None;
+
+    struct tag;
+    using value = counting_type<tag>;
+    using counted_option = roc::option<value>;
+
+    value::reset();
+
+    SUBCASE("constructing") {
+        {
+            value v{1};
+            counted_option moved = Some(roc::move(v));
+            REQUIRE_OPS(value, copies == 0, moves == 1, live == 2);
+
+            counted_option direct{value{2}};
+            REQUIRE_OPS(value, copies == 0, moves == 2, live == 3);
+
+            counted_option copied = moved;
+            REQUIRE_OPS(value, copies == 1, moves == 2, live == 4);
+
+            counted_option taken = roc::move(moved);
+            REQUIRE_OPS(value, copies == 1, moves == 3, live == 5);
+
+            counted_option empty = None;
+            counted_option empty_copy = empty;
+            REQUIRE_OPS(value, copies == 1, moves == 3, default_constructs == 0);
+        }
+        REQUIRE_OPS(value, live == 0);
+    }
+
+    SUBCASE("assigning") {
+        counted_option lhs = Some(value{1});
+        counted_option rhs = Some(value{2});
+        counted_option empty;
+        value::reset();
+
+        lhs = rhs;
+        REQUIRE_OPS(value, copies == 0, moves == 0, copy_assigns == 1, move_assigns == 0);
+
+        lhs = roc::move(rhs);
+        REQUIRE_OPS(value, copies == 0, moves == 0, copy_assigns == 1, move_assigns == 1);
+
+        empty = lhs;
+        REQUIRE_OPS(value, copies == 1, copy_assigns == 1, live == 1);
+
+        lhs = None;
+        REQUIRE_OPS(value, destroys == 1, live == 0);
+
+        lhs = roc::move(empty);
+        REQUIRE_OPS(value, copies == 1, moves == 1, copy_assigns == 1, move_assigns == 1, live == 1);
+
+        empty = counted_option{};
+        REQUIRE_OPS(value, destroys == 2, live == 0);
+    }
+
+    SUBCASE("unwrapping") {
+        counted_option opt = Some(value{1});
+        value::reset();
+
+        REQUIRE(opt.unwrap().value == 1);
+        REQUIRE(opt.unwrap_or(value{5}).value == 1);
+        REQUIRE_OPS(value, copies == 1, moves == 0, live == 0);
+
+        value taken = roc::move(opt).unwrap_or(value{5});
+        REQUIRE(taken.value == 1);
+        REQUIRE_OPS(value, copies == 1, moves == 1, live == 1);
+    }
+
+    SUBCASE("combinators") {
+        counted_option opt = Some(value{1});
+        value::reset();
+
+        REQUIRE(opt.map([](value& v) { return v.value + 1; }).contains(2));
+        REQUIRE(opt.and_then([](value& v) { return roc::option<int>{v.value}; }).contains(1));
+        REQUIRE_OPS(value, copies == 0, moves == 0, live == 0);
+
+        auto mapped = opt.map([](value& v) { return value{v.value + 1}; });
+        REQUIRE_OPS(value, copies == 0, moves == 1, live == 1);
+        REQUIRE(mapped.unwrap().value == 2);
+    }
+}
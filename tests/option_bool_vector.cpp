@@ -0,0 +1,87 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <vector>
+
+#include <roc/option_bool_vector.hpp>
+
+using namespace roc::import;
+
+TEST_CASE("roc::option_bool_vector - basic interface") {
+    roc::option_bool_vector flags(5);
+
+    REQUIRE(flags.size() == 5);
+    REQUIRE(flags.count_none() == 5);
+    REQUIRE(flags[3].is_none());
+
+    flags.set(0, true);
+    flags.set(1, false);
+    flags.set(2, roc::option<bool>{true});
+    REQUIRE(flags[0].contains(true));
+    REQUIRE(flags[1].contains(false));
+    REQUIRE(flags.get(2).contains(true));
+    REQUIRE(flags.count_some() == 3);
+    REQUIRE(flags.count_true() == 2);
+    REQUIRE(flags.count_false() == 1);
+    REQUIRE(flags.count_none() == 2);
+
+    SUBCASE("reset clears both bits") {
+        flags.reset(0);
+        REQUIRE(flags[0].is_none());
+        REQUIRE(flags.count_true() == 1);
+
+        flags.set(2, roc::option<bool>{});
+        REQUIRE(flags[2].is_none());
+        REQUIRE(flags.count_true() == 0);
+    }
+
+    SUBCASE("overwriting a value") {
+        flags.set(0, false);
+        REQUIRE(flags[0].contains(false));
+        REQUIRE(flags.count_false() == 2);
+    }
+}
+
+TEST_CASE("roc::option_bool_vector - counts match a plain vector") {
+    roc::option_bool_vector packed;
+    std::vector<roc::option<bool>> plain;
+
+    for (unsigned i = 0; i < 1000; ++i) {
+        roc::option<bool> element;
+        if (i % 3 != 0)
+            element = Some(i % 7 < 3);
+        packed.push_back(element);
+        plain.push_back(element);
+    }
+
+    std::size_t some = 0, trues = 0;
+    for (std::size_t i = 0; i < plain.size(); ++i) {
+        REQUIRE(packed[i].is_some() == plain[i].is_some());
+        if (plain[i].is_some()) {
+            ++some;
+            trues += plain[i].unwrap();
+            REQUIRE(packed[i].unwrap() == plain[i].unwrap());
+        }
+    }
+
+    REQUIRE(packed.size() == 1000);
+    REQUIRE(packed.count_some() == some);
+    REQUIRE(packed.count_true() == trues);
+    REQUIRE(packed.count_false() == some - trues);
+
+    SUBCASE("shrinking drops the tail from the counts") {
+        packed.resize(10);
+        std::size_t head_some = 0, head_true = 0;
+        for (std::size_t i = 0; i < 10; ++i)
+            if (plain[i].is_some()) {
+                ++head_some;
+                head_true += plain[i].unwrap();
+            }
+        REQUIRE(packed.count_some() == head_some);
+        REQUIRE(packed.count_true() == head_true);
+
+        packed.resize(100);
+        REQUIRE(packed[50].is_none());
+        REQUIRE(packed.count_some() == head_some);
+    }
+}
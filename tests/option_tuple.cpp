@@ -0,0 +1,178 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <roc/option_tuple.hpp>
+
+namespace {
+    // a decoded message with a handful of optional scalar fields
+    using message = roc::option_tuple<std::uint8_t, double, std::uint16_t, std::uint32_t, double, bool, std::int64_t>;
+
+    struct unpacked_message
+    {
+        roc::option<std::uint8_t> a;
+        roc::option<double> b;
+        roc::option<std::uint16_t> c;
+        roc::option<std::uint32_t> d;
+        roc::option<double> e;
+        roc::option<bool> f;
+        roc::option<std::int64_t> g;
+    };
+
+    static_assert(sizeof(message::mask_type) == 1);
+    static_assert(sizeof(message) == 40); // 8+8+8 + 4 + 2 + 1 + 1 + mask, rounded to 8
+    static_assert(sizeof(message) < sizeof(unpacked_message));
+    static_assert(std::is_trivially_copyable<message>::value);
+    static_assert(message::ALL == 0x7f);
+    static_assert(message::mask_of<0, 3>() == 0x09);
+    static_assert(sizeof(roc::option_tuple<char, char, char, char, char, char, char, char, char>::mask_type) == 2);
+
+    // counts live objects, copying one built from a negative value throws
+    struct counted
+    {
+        static inline int live = 0;
+
+        explicit counted(int v) : value(v) { live++; }
+        counted(const counted& rhs) : value(rhs.value) {
+            if (rhs.value < 0)
+                throw std::runtime_error("copy");
+            live++;
+        }
+        counted(counted&& rhs) noexcept : value(rhs.value) { live++; }
+        counted& operator=(const counted&) = default;
+        ~counted() { live--; }
+
+        int value;
+    };
+}
+
+TEST_CASE("roc::option_tuple - fields") {
+    message msg;
+    REQUIRE(msg.present_mask() == 0);
+    REQUIRE(msg.count() == 0);
+    REQUIRE(msg.get<1>().is_none());
+
+    msg.set<1>(2.5);
+    msg.emplace<3>(7u);
+    msg.set<6>(-3);
+
+    REQUIRE(msg.get<1>().unwrap() == 2.5);
+    REQUIRE(msg.get<3>().unwrap() == 7u);
+    REQUIRE(msg.get<6>().unwrap() == -3);
+    REQUIRE(msg.get<0>().is_none());
+    REQUIRE(msg.count() == 3);
+
+    SUBCASE("get returns a reference into the tuple") {
+        msg.get<3>().unwrap() += 1;
+        REQUIRE(msg.get<3>().unwrap() == 8u);
+
+        const message& const_msg = msg;
+        REQUIRE(const_msg.get<3>().unwrap() == 8u);
+    }
+
+    SUBCASE("masks") {
+        REQUIRE(msg.present_mask() == message::mask_of<1, 3, 6>());
+        REQUIRE(msg.has_all(message::mask_of<1, 3>()));
+        REQUIRE(not msg.has_all(message::mask_of<1, 2>()));
+        REQUIRE(msg.has_any(message::mask_of<0, 6>()));
+        REQUIRE(not msg.has_any(message::mask_of<0, 2>()));
+        REQUIRE(not msg.has_all(message::ALL));
+    }
+
+    SUBCASE("reset / take / clear") {
+        msg.reset<1>();
+        REQUIRE(msg.get<1>().is_none());
+
+        auto taken = msg.take<3>();
+        REQUIRE(taken.unwrap() == 7u);
+        REQUIRE(msg.is_none<3>());
+        REQUIRE(msg.take<3>().is_none());
+
+        msg.clear();
+        REQUIRE(msg.present_mask() == 0);
+    }
+
+    SUBCASE("fields don't overlap") {
+        msg.set<0>(std::uint8_t{0xff});
+        msg.set<2>(std::uint16_t{0xffff});
+        msg.set<4>(-1.0);
+        msg.set<5>(true);
+
+        REQUIRE(msg.get<1>().unwrap() == 2.5);
+        REQUIRE(msg.get<3>().unwrap() == 7u);
+        REQUIRE(msg.get<6>().unwrap() == -3);
+        REQUIRE(msg.has_all(message::ALL));
+    }
+}
+
+TEST_CASE("roc::option_tuple - non-trivial fields") {
+    using record = roc::option_tuple<std::string, int, std::string>;
+    static_assert(not std::is_trivially_copyable<record>::value);
+
+    record r;
+    r.set<0>("name");
+    r.set<1>(3);
+
+    SUBCASE("copy keeps absent fields absent") {
+        record copy = r;
+        REQUIRE(copy.get<0>().unwrap() == "name");
+        REQUIRE(copy.get<1>().unwrap() == 3);
+        REQUIRE(copy.get<2>().is_none());
+
+        copy.set<2>("other");
+        r = copy;
+        REQUIRE(r.get<2>().unwrap() == "other");
+    }
+
+    SUBCASE("move") {
+        record moved = roc::move(r);
+        REQUIRE(moved.get<0>().unwrap() == "name");
+
+        record assigned;
+        assigned.set<2>("replaced");
+        assigned = roc::move(moved);
+        REQUIRE(assigned.get<0>().unwrap() == "name");
+        REQUIRE(assigned.get<2>().is_none());
+    }
+
+    SUBCASE("set assigns to a present field") {
+        r.set<0>("renamed");
+        REQUIRE(r.get<0>().unwrap() == "renamed");
+        REQUIRE(r.take<0>().unwrap() == "renamed");
+        REQUIRE(r.get<0>().is_none());
+    }
+}
+
+TEST_CASE("roc::option_tuple - a throwing copy leaks nothing") {
+    using record = roc::option_tuple<counted, counted, counted>;
+    static_assert(std::is_nothrow_move_constructible<record>::value);
+    static_assert(std::is_nothrow_move_assignable<record>::value);
+
+    {
+        record r;
+        r.emplace<0>(1);
+        r.emplace<1>(2);
+        r.emplace<2>(-3);
+        REQUIRE(counted::live == 3);
+
+        SUBCASE("copy constructor") {
+            REQUIRE_THROWS_AS(record{r}, std::runtime_error);
+            REQUIRE(counted::live == 3);
+        }
+
+        SUBCASE("copy assignment") {
+            record target;
+            target.emplace<1>(5);
+            REQUIRE_THROWS_AS(target = r, std::runtime_error);
+            REQUIRE(counted::live == 5);
+            REQUIRE(target.get<0>().unwrap().value == 1);
+            REQUIRE(target.get<1>().unwrap().value == 2);
+            REQUIRE(target.get<2>().is_none());
+        }
+    }
+    REQUIRE(counted::live == 0);
+}
@@ -0,0 +1,29 @@
+#define ROC_ENABLE_ERROR_TRACE
+#include <iostream>
+#include "doctest.h"
+
+#include <roc/ptr_result.hpp>
+
+using namespace roc::import;
+
+TEST_CASE("roc::ptr_result - combinators with error traces on") {
+    roc::error_trace::clear();
+
+    int value = 3;
+    const roc::ptr_result<int, int> ok = Ok(&value);
+    const roc::ptr_result<int, int> err = Err(5);
+    auto same = [](int* p) { return roc::ptr_result<int, int>{Ok(p)}; };
+
+    REQUIRE(ok.and_then(same).contains(&value));
+    REQUIRE(err.and_then(same).contains_err(5));
+    REQUIRE(err.map([](int* p) { return *p; }).contains_err(5));
+    REQUIRE(err.map_err([](int e) { return e + 1; }).contains_err(6));
+    REQUIRE(err.or_else([&](int) { return roc::ptr_result<int, int>{Ok(&value)}; }).contains(&value));
+
+    SUBCASE("the word has no trace, so a traced error is left alone") {
+        roc::result<int, int> traced = Err(1);
+        REQUIRE(roc::error_trace::of(traced).size() == 1);
+        REQUIRE(err.and_then(same).is_err());
+        REQUIRE(roc::error_trace::of(traced).size() == 1);
+    }
+}
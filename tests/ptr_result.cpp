@@ -0,0 +1,123 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <cstdint>
+#include <thread>
+
+#include <roc/ptr_result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    enum class lookup_error : std::uint8_t { missing = 1, stale, corrupt };
+
+    struct node
+    {
+        int key;
+        node* next;
+    };
+
+    static_assert(sizeof(roc::ptr_result<node, lookup_error>) == sizeof(void*));
+    static_assert(std::is_trivially_copyable<roc::ptr_result<node, lookup_error>>::value);
+    static_assert(roc::atomic_ptr_result<node, lookup_error>::is_always_lock_free);
+
+    roc::ptr_result<node, lookup_error> find(node* head, int key)
+    {
+        for (node* n = head; n != nullptr; n = n->next)
+            if (n->key == key)
+                return Ok(n);
+        return Err(lookup_error::missing);
+    }
+}
+
+TEST_CASE("roc::ptr_result - tagged pointer") {
+    node c{3, nullptr};
+    node b{2, &c};
+    node a{1, &b};
+
+    auto found = find(&a, 2);
+    REQUIRE(found.is_ok());
+    REQUIRE(found.unwrap() == &b);
+    REQUIRE(found.contains(&b));
+
+    auto missing = find(&a, 7);
+    REQUIRE(missing.is_err());
+    REQUIRE(missing.err_value() == lookup_error::missing);
+    REQUIRE(missing.contains_err(lookup_error::missing));
+    REQUIRE(missing.unwrap_or(&c) == &c);
+
+    SUBCASE("Ok from a reference and Ok(nullptr)") {
+        roc::ptr_result<node, lookup_error> by_ref = Ok(c);
+        REQUIRE(by_ref.unwrap() == &c);
+
+        roc::ptr_result<node, lookup_error> null = Ok(static_cast<node*>(nullptr));
+        REQUIRE(null.is_ok());
+        REQUIRE(null.unwrap() == nullptr);
+    }
+
+    SUBCASE("negative and wide error codes") {
+        roc::ptr_result<node, int> negative = Err(-12);
+        REQUIRE(negative.err_value() == -12);
+
+        roc::ptr_result<node, std::int64_t> wide = Err(std::int64_t{1} << 40);
+        REQUIRE(wide.err_value() == std::int64_t{1} << 40);
+    }
+
+    SUBCASE("combinators") {
+        auto next = [](node* n) -> roc::ptr_result<node, lookup_error> {
+            if (n->next == nullptr) return Err(lookup_error::stale);
+            return Ok(n->next);
+        };
+        REQUIRE(found.and_then(next).unwrap() == &c);
+        REQUIRE(found.and_then(next).and_then(next).err_value() == lookup_error::stale);
+        REQUIRE(missing.and_then(next).err_value() == lookup_error::missing);
+
+        auto key = found.map([](node* n) { return n->key; });
+        static_assert(std::is_same<decltype(key), roc::result<int, lookup_error>>::value);
+        REQUIRE(key.unwrap() == 2);
+
+        auto following = found.map([](node* n) { return n->next; });
+        static_assert(std::is_same<decltype(following), roc::ptr_result<node, lookup_error>>::value);
+        REQUIRE(following.unwrap() == &c);
+
+        auto code = missing.map_err([](lookup_error e) { return static_cast<int>(e) * 10; });
+        REQUIRE(code.err_value() == 10);
+
+        auto fallback = missing.or_else([&](lookup_error) -> roc::ptr_result<node, lookup_error> { return Ok(&a); });
+        REQUIRE(fallback.unwrap() == &a);
+
+        roc::result<node*, lookup_error> widened = missing;
+        REQUIRE(widened.err_value() == lookup_error::missing);
+    }
+}
+
+TEST_CASE("roc::atomic_ptr_result") {
+    node a{1, nullptr};
+    node b{2, nullptr};
+
+    roc::atomic_ptr_result<node, lookup_error> slot{Err(lookup_error::missing)};
+    REQUIRE(slot.load().err_value() == lookup_error::missing);
+
+    slot.store(Ok(&a));
+    REQUIRE(slot.load().unwrap() == &a);
+
+    auto previous = slot.exchange(Err(lookup_error::corrupt));
+    REQUIRE(previous.unwrap() == &a);
+
+    roc::ptr_result<node, lookup_error> expected = Ok(&a);
+    REQUIRE(not slot.compare_exchange_strong(expected, Ok(&b)));
+    REQUIRE(expected.err_value() == lookup_error::corrupt);
+    REQUIRE(slot.compare_exchange_strong(expected, Ok(&b)));
+    REQUIRE(slot.load().unwrap() == &b);
+
+    SUBCASE("concurrent publish") {
+        roc::atomic_ptr_result<node, lookup_error> shared{Err(lookup_error::missing)};
+        std::thread writer([&] { shared.store(Ok(&a), std::memory_order_release); });
+
+        roc::ptr_result<node, lookup_error> seen = Err(lookup_error::missing);
+        while ((seen = shared.load(std::memory_order_acquire)).is_err())
+            std::this_thread::yield();
+        writer.join();
+        REQUIRE(seen.unwrap()->key == 1);
+    }
+}
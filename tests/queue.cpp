@@ -0,0 +1,166 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <roc/queue.hpp>
+
+using namespace roc::import;
+
+namespace {
+    // no default constructor, move only, counts live instances
+    struct tracked {
+        static inline int live = 0;
+
+        explicit tracked(int v) : value(v) { live++; }
+        tracked(tracked&& other) noexcept : value(other.value) { live++; }
+        tracked(const tracked&) = delete;
+        tracked& operator=(const tracked&) = delete;
+        ~tracked() { live--; }
+
+        int value;
+    };
+}
+
+TEST_CASE("roc::spsc_queue - push / pop") {
+    roc::spsc_queue<int, 4> queue;
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE(queue.empty());
+    REQUIRE(queue.try_pop().is_none());
+
+    for (int i = 0; i < 4; ++i)
+        REQUIRE(queue.try_push(i).is_ok());
+
+    SUBCASE("full queue hands the value back") {
+        auto rejected = queue.try_push(99);
+        REQUIRE(rejected.is_err());
+        REQUIRE(rejected.contains_err(99));
+    }
+
+    SUBCASE("values come out in order") {
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(queue.try_pop().contains(i));
+        REQUIRE(queue.try_pop().is_none());
+        REQUIRE(queue.try_push(4).is_ok());
+        REQUIRE(queue.try_pop().contains(4));
+    }
+}
+
+TEST_CASE("roc::spsc_queue - values are moved, never default constructed") {
+    tracked::live = 0;
+    {
+        roc::spsc_queue<tracked, 2> queue;
+        REQUIRE(tracked::live == 0);
+
+        REQUIRE(queue.try_push(tracked{1}).is_ok());
+        REQUIRE(queue.try_push(tracked{2}).is_ok());
+        REQUIRE(tracked::live == 2);
+
+        auto rejected = queue.try_push(tracked{3});
+        REQUIRE(rejected.is_err());
+        REQUIRE(rejected.err_value().value == 3);
+
+        auto popped = queue.try_pop();
+        REQUIRE(popped.is_some());
+        REQUIRE(popped.unwrap().value == 1);
+    }
+    // the one left in the queue is destroyed with it
+    REQUIRE(tracked::live == 0);
+}
+
+TEST_CASE("roc::spsc_queue - threaded") {
+    constexpr int count = 20000;
+    roc::spsc_queue<int, 64> queue;
+    long sum = 0;
+    bool in_order = true;
+
+    std::thread consumer([&] {
+        for (int received = 0; received < count;) {
+            auto v = queue.try_pop();
+            if (v.is_some()) {
+                in_order = in_order && v.unwrap() == received;
+                sum += v.unwrap();
+                received++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (int i = 0; i < count; ++i)
+        while (queue.try_push(i).is_err())
+            std::this_thread::yield();
+
+    consumer.join();
+    REQUIRE(in_order);
+    REQUIRE(sum == long(count) * (count - 1) / 2);
+}
+
+TEST_CASE("roc::mpmc_queue - push / pop") {
+    roc::mpmc_queue<std::unique_ptr<int>> queue(3);
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE(queue.try_pop().is_none());
+
+    for (int i = 0; i < 4; ++i)
+        REQUIRE(queue.try_push(std::make_unique<int>(i)).is_ok());
+
+    auto rejected = queue.try_push(std::make_unique<int>(42));
+    REQUIRE(rejected.is_err());
+    REQUIRE(*rejected.err_value() == 42);
+
+    for (int i = 0; i < 4; ++i) {
+        auto v = queue.try_pop();
+        REQUIRE(v.is_some());
+        REQUIRE(*v.unwrap() == i);
+    }
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("roc::mpmc_queue - destroys leftover values") {
+    tracked::live = 0;
+    {
+        roc::mpmc_queue<tracked> queue(8);
+        for (int i = 0; i < 5; ++i)
+            REQUIRE(queue.try_push(tracked{i}).is_ok());
+        REQUIRE(queue.try_pop().unwrap().value == 0);
+    }
+    REQUIRE(tracked::live == 0);
+}
+
+TEST_CASE("roc::mpmc_queue - threaded") {
+    constexpr int producers = 3;
+    constexpr int consumers = 3;
+    constexpr int per_producer = 5000;
+
+    roc::mpmc_queue<int> queue(128);
+    std::atomic<long> sum {0};
+    std::atomic<int> received {0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            for (int i = 1; i <= per_producer; ++i)
+                while (queue.try_push(i).is_err())
+                    std::this_thread::yield();
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            while (received < producers * per_producer) {
+                auto v = queue.try_pop();
+                if (v.is_some()) {
+                    sum += v.unwrap();
+                    received++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    REQUIRE(sum == long(producers) * per_producer * (per_producer + 1) / 2);
+}
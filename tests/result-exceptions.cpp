@@ -2,10 +2,12 @@
 #include "doctest.h"
 
 #include <array>
+#include <cstdint>
 
 #define ROC_ENABLE_EXCEPTIONS
 
 #include <roc/result.hpp>
+#include <roc/ptr_result.hpp>
 
 TEST_CASE("result - correct exceptions are thrown") {
     using roc::import::Ok;
@@ -18,3 +20,21 @@ TEST_CASE("result - correct exceptions are thrown") {
     i = Ok(42); // just some valid value
     REQUIRE(i.unwrap());
 }
+
+TEST_CASE("ptr_result - codes that lose their top bit are rejected") {
+    using roc::import::Err;
+    using roc::ptr_result;
+
+    const std::int64_t largest = INTPTR_MAX / 2;
+    const std::int64_t smallest = INTPTR_MIN / 2;
+    REQUIRE(ptr_result<std::int64_t, std::int64_t>{Err(largest)}.err_value() == largest);
+    REQUIRE(ptr_result<std::int64_t, std::int64_t>{Err(smallest)}.err_value() == smallest);
+    REQUIRE(ptr_result<std::int64_t, std::uint64_t>{Err(std::uint64_t(largest))}.err_value() == std::uint64_t(largest));
+
+    REQUIRE_THROWS_AS((ptr_result<std::int64_t, std::int64_t>{Err(largest + 1)}), roc::bad_error_code);
+    REQUIRE_THROWS_AS((ptr_result<std::int64_t, std::int64_t>{Err(smallest - 1)}), roc::bad_error_code);
+    REQUIRE_THROWS_AS((ptr_result<std::int64_t, std::uint64_t>{Err(std::uint64_t(largest) + 1)}), roc::bad_error_code);
+
+    // narrower codes always fit
+    static_assert(std::is_nothrow_constructible<ptr_result<std::int64_t, std::int32_t>, roc::detail::error_type<std::int32_t>>::value);
+}
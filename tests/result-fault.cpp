@@ -0,0 +1,159 @@
+#define ROC_FAULT_INJECTION
+#include <iostream>
+#include "doctest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <roc/fault.hpp>
+
+using namespace roc::import;
+
+namespace {
+    enum class io_error { injected = 1, real = 2 };
+
+    roc::result<int, io_error> read_block(int block)
+    {
+        ROC_INJECT_FAULT(io_error::injected);
+        if (block < 0)
+            return Err(io_error::real);
+        return Ok(block * 2);
+    }
+
+    roc::result<int, io_error> write_block(int block)
+    {
+        ROC_INJECT_FAULT(io_error::injected);
+        return Ok(block + 0);
+    }
+
+    std::vector<bool> failures(int calls)
+    {
+        std::vector<bool> failed;
+        for (int i = 0; i < calls; ++i)
+            failed.push_back(read_block(i).is_err());
+        return failed;
+    }
+
+    const roc::fault::site_stats* find_site(const std::vector<roc::fault::site_stats>& sites, const std::string& function)
+    {
+        for (const auto& site : sites)
+            if (site.function == function)
+                return &site;
+        return nullptr;
+    }
+}
+
+TEST_CASE("roc::fault - injects Err by schedule") {
+    SUBCASE("rate 0 never fails, rate 1 always does") {
+        roc::fault::configure({});
+        for (int i = 0; i < 100; ++i)
+            REQUIRE(read_block(i).contains(i * 2));
+
+        roc::fault::configure({.seed = 1, .rate = 1.0, .rules = {}});
+        for (int i = 0; i < 100; ++i)
+            REQUIRE(read_block(i).contains_err(io_error::injected));
+    }
+
+    SUBCASE("same seed fails the same calls, another seed different ones") {
+        roc::fault::configure({.seed = 42, .rate = 0.25, .rules = {}});
+        const auto first = failures(1000);
+        roc::fault::configure({.seed = 42, .rate = 0.25, .rules = {}});
+        const auto second = failures(1000);
+        roc::fault::configure({.seed = 43, .rate = 0.25, .rules = {}});
+        const auto other = failures(1000);
+
+        REQUIRE(first == second);
+        REQUIRE(first != other);
+
+        // binomial with mean 250 and standard deviation 13.7, six deviations
+        // either way
+        const auto injected = std::count(first.begin(), first.end(), true);
+        REQUIRE(injected > 168);
+        REQUIRE(injected < 332);
+    }
+
+    SUBCASE("calls are counted per thread") {
+        roc::fault::configure({.seed = 42, .rate = 0.25, .rules = {}});
+        const auto alone = failures(1000);
+
+        // the same calls on two threads at once fail the same way on each
+        roc::fault::configure({.seed = 42, .rate = 0.25, .rules = {}});
+        std::vector<bool> first, second;
+        std::thread a([&] { first = failures(1000); });
+        std::thread b([&] { second = failures(1000); });
+        a.join();
+        b.join();
+
+        REQUIRE(first == alone);
+        REQUIRE(second == alone);
+        REQUIRE(find_site(roc::fault::sites(), "read_block")->calls == 2000);
+    }
+
+    SUBCASE("rules pick sites by function or file:line") {
+        roc::fault::configure({.seed = 7, .rate = 0.0, .rules = {{"write_block", 1.0}}});
+        REQUIRE(read_block(1).is_ok());
+        REQUIRE(write_block(1).is_err());
+
+        const auto sites = roc::fault::sites();
+        const auto* read = find_site(sites, "read_block");
+        REQUIRE(read != nullptr);
+        const std::string location = "result-fault.cpp:" + std::to_string(read->line);
+
+        roc::fault::configure({.seed = 7, .rate = 1.0, .rules = {{location, 0.0}}});
+        REQUIRE(read_block(1).is_ok());
+        REQUIRE(write_block(1).is_err());
+    }
+
+    SUBCASE("the path the file was built from doesn't change the faults") {
+        using roc::fault::detail::site_key;
+        REQUIRE(site_key("/home/build/src/io.cpp", 12) == site_key("io.cpp", 12));
+        REQUIRE(site_key("../src/io.cpp", 12) == site_key("src/io.cpp", 12));
+        REQUIRE(site_key("io.cpp", 12) != site_key("io.cpp", 13));
+        REQUIRE(site_key("io.cpp", 12) != site_key("net.cpp", 12));
+    }
+
+    SUBCASE("counts calls and injections per site") {
+        roc::fault::configure({.seed = 3, .rate = 0.5, .rules = {}});
+        for (int i = 0; i < 200; ++i)
+            (void)read_block(i);
+
+        const auto sites = roc::fault::sites();
+        const auto* read = find_site(sites, "read_block");
+        REQUIRE(read != nullptr);
+        REQUIRE(read->calls == 200);
+        REQUIRE(read->injected > 50);
+        REQUIRE(read->injected < 150);
+    }
+
+    roc::fault::configure({});
+}
+
+TEST_CASE("roc::fault - schedule from text and the environment") {
+    auto parsed = roc::fault::parse_schedule("seed=0x10,rate=0.5,read_block=1,io.cpp:12=0");
+    REQUIRE(parsed.is_ok());
+    const auto& schedule = parsed.unwrap();
+    REQUIRE(schedule.seed == 16);
+    REQUIRE(schedule.rate == 0.5);
+    REQUIRE(schedule.rules.size() == 2);
+    REQUIRE(schedule.rules[1].site == "io.cpp:12");
+
+    REQUIRE(roc::fault::parse_schedule("rate=2").contains_err(0));
+    REQUIRE(roc::fault::parse_schedule("seed=1,rate").contains_err(7));
+    REQUIRE(roc::fault::parse_schedule("seed=1,rate=x").contains_err(7));
+
+    ::setenv("ROC_FAULT_SCHEDULE", "seed=5,read_block=1", 1);
+    REQUIRE(roc::fault::configure_from_environment().is_ok());
+    REQUIRE(read_block(1).is_err());
+    REQUIRE(write_block(1).is_ok());
+
+    ::setenv("ROC_FAULT_SCHEDULE", "seed=5,read_block", 1);
+    REQUIRE(roc::fault::configure_from_environment().is_err());
+    REQUIRE(read_block(1).is_err());
+
+    ::unsetenv("ROC_FAULT_SCHEDULE");
+    REQUIRE(roc::fault::configure_from_environment().is_ok());
+    REQUIRE(read_block(1).is_ok());
+}
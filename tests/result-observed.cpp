@@ -0,0 +1,117 @@
+#define ROC_CHECK_OBSERVED
+#include <iostream>
+#include "doctest.h"
+
+#include <cstring>
+#include <source_location>
+
+#include <roc/result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    unsigned reported_line = 0;
+    const char* reported_function = nullptr;
+
+    void remember_unobserved_error(const std::source_location& origin) noexcept
+    {
+        reported_line = origin.line();
+        reported_function = origin.function_name();
+    }
+
+    roc::result<int, int> fails(unsigned& line)
+    {
+        line = std::source_location::current().line() + 1;
+        return Err(5);
+    }
+
+    roc::result<int, int> succeeds()
+    {
+        return Ok(5);
+    }
+
+    roc::result<void, int> fails_void()
+    {
+        return Err(6);
+    }
+
+    struct handler_guard
+    {
+        handler_guard(roc::unobserved_error_handler handler) : previous(roc::set_unobserved_error_handler(handler)) {}
+        ~handler_guard() { roc::set_unobserved_error_handler(previous); }
+
+        roc::unobserved_error_handler previous;
+    };
+}
+
+TEST_CASE("roc::result - unobserved errors are reported when destroyed") {
+    handler_guard guard(remember_unobserved_error);
+    const auto before = roc::unobserved_error_count();
+    unsigned line = 0;
+
+    SUBCASE("an unchecked Err is reported with its origin") {
+        (void)fails(line);
+        REQUIRE(roc::unobserved_error_count() == before + 1);
+        REQUIRE(reported_line == line);
+        REQUIRE(std::strstr(reported_function, "fails") != nullptr);
+    }
+
+    SUBCASE("checking with is_ok or is_err counts") {
+        REQUIRE(fails(line).is_err());
+        REQUIRE(not fails(line).is_ok());
+        REQUIRE(fails_void().is_err());
+        REQUIRE(roc::unobserved_error_count() == before);
+    }
+
+    SUBCASE("anything built on them counts too") {
+        REQUIRE(fails(line).unwrap_or(1) == 1);
+        REQUIRE(fails(line).contains_err(5));
+        REQUIRE(fails(line).map([](int v) { return v + 1; }).err_value() == 5);
+        REQUIRE(roc::unobserved_error_count() == before);
+    }
+
+    SUBCASE("an unchecked Ok is never reported") {
+        (void)succeeds();
+        REQUIRE(roc::unobserved_error_count() == before);
+    }
+
+    SUBCASE("moving out marks the moved-from result") {
+        auto first = fails(line);
+        auto second = roc::move(first);
+        REQUIRE(second.is_err());
+    }
+
+    SUBCASE("copies have to be checked on their own") {
+        {
+            auto first = fails(line);
+            auto copy = first;
+            REQUIRE(first.is_err());
+        }
+        REQUIRE(roc::unobserved_error_count() == before + 1);
+    }
+
+    SUBCASE("one-byte results are checked the same way") {
+        {
+            roc::result<bool, unsigned char> flag = Err(static_cast<unsigned char>(4));
+        }
+        REQUIRE(roc::unobserved_error_count() == before + 1);
+
+        roc::result<bool, unsigned char> checked = Err(static_cast<unsigned char>(4));
+        REQUIRE(checked.is_err());
+    }
+
+    SUBCASE("ignore_unobserved_error only counts") {
+        handler_guard quiet(roc::ignore_unobserved_error);
+        reported_line = 0;
+        (void)fails(line);
+        REQUIRE(roc::unobserved_error_count() == before + 1);
+        REQUIRE(reported_line == 0);
+    }
+
+    REQUIRE(roc::unobserved_error_count() >= before);
+}
+
+TEST_CASE("roc::result - observation bookkeeping is in the result when enabled") {
+    static_assert(sizeof(roc::result<int, int>) > sizeof(roc::detail::result_storage<int, int>));
+    static_assert(not std::is_trivially_destructible<roc::result<int, int>>::value);
+}
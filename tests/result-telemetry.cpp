@@ -0,0 +1,132 @@
+#define ROC_ENABLE_TELEMETRY
+#include <iostream>
+#include "doctest.h"
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <roc/result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    roc::result<int, int> parse_digit(char c)
+    {
+        if (c < '0' || c > '9')
+            return Err(1);
+        return Ok(c - '0');
+    }
+
+    roc::result<int, int> always_fails()
+    {
+        return Err(2);
+    }
+
+    std::uint64_t count_in(const char* function_part)
+    {
+        std::uint64_t count = 0;
+        for (const auto& site : roc::telemetry::snapshot())
+            if (std::strstr(site.function, function_part) != nullptr)
+                count += site.count;
+        return count;
+    }
+
+    // one site per instantiation, the function names differ
+    template <int N>
+    roc::result<int, int> fails_at()
+    {
+        return Err(N);
+    }
+
+    template <int... Ns>
+    void fail_everywhere(std::integer_sequence<int, Ns...>)
+    {
+        ((void)fails_at<Ns>(), ...);
+    }
+
+    // Err in a constant expression isn't counted
+    static_assert(static_cast<int>(Err(3)) == 3);
+}
+
+TEST_CASE("roc::telemetry - counts Err per call site") {
+    roc::telemetry::reset();
+
+    for (char c : "12x4yz")
+        (void)parse_digit(c);
+    for (int i = 0; i < 5; ++i)
+        (void)always_fails();
+
+    // the terminating null of the literal is an error too
+    REQUIRE(count_in("parse_digit") == 4);
+    REQUIRE(count_in("always_fails") == 5);
+
+    SUBCASE("most frequent site comes first, with its location") {
+        const auto sites = roc::telemetry::snapshot();
+        REQUIRE(sites.size() == 2);
+        REQUIRE(std::strstr(sites[0].function, "always_fails") != nullptr);
+        REQUIRE(std::strstr(sites[0].file, "result-telemetry.cpp") != nullptr);
+        REQUIRE(sites[0].line == 25);
+    }
+
+    SUBCASE("reset zeroes the counts") {
+        roc::telemetry::reset();
+        REQUIRE(roc::telemetry::snapshot().empty());
+        (void)always_fails();
+        REQUIRE(count_in("always_fails") == 1);
+    }
+}
+
+TEST_CASE("roc::telemetry - merges threads, including exited ones") {
+    roc::telemetry::reset();
+
+    constexpr int threads = 4;
+    constexpr int errors_per_thread = 1000;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([] {
+            for (int i = 0; i < errors_per_thread; ++i)
+                (void)always_fails();
+        });
+    for (auto& worker : workers)
+        worker.join();
+
+    (void)always_fails();
+
+    const auto sites = roc::telemetry::snapshot();
+    REQUIRE(sites.size() == 1);
+    REQUIRE(sites[0].count == threads * errors_per_thread + 1);
+}
+
+TEST_CASE("roc::telemetry - the per-thread table grows") {
+    roc::telemetry::reset();
+
+    constexpr int sites = 100;
+    fail_everywhere(std::make_integer_sequence<int, sites>{});
+    fail_everywhere(std::make_integer_sequence<int, sites>{});
+
+    REQUIRE(count_in("fails_at") == 2 * sites);
+    for (const auto& site : roc::telemetry::snapshot())
+        REQUIRE(site.count == 2);
+}
+
+TEST_CASE("roc::telemetry - sites are merged by name, not by pointer") {
+    // two translation units each have their own copy of the strings
+    std::string file_a = "include/parser.hpp", file_b = file_a;
+    std::string function_a = "int parse()", function_b = function_a;
+
+    std::vector<roc::telemetry::site_count> sites = {
+        {file_a.c_str(), function_a.c_str(), 10, 5, 3},
+        {file_b.c_str(), function_b.c_str(), 10, 5, 4},
+        {file_b.c_str(), function_b.c_str(), 11, 5, 1},
+    };
+    roc::telemetry::detail::merge_sites(sites);
+
+    REQUIRE(sites.size() == 2);
+    REQUIRE(sites[0].line == 10);
+    REQUIRE(sites[0].count == 7);
+    REQUIRE(sites[1].count == 1);
+}
@@ -0,0 +1,118 @@
+#define ROC_ENABLE_ERROR_TRACE
+#include <iostream>
+#include "doctest.h"
+
+#include <sstream>
+#include <string>
+
+#include <roc/result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    [[gnu::noinline]] roc::result<int, int> open_file(int fd)
+    {
+        if (fd < 0)
+            return Err(9);
+        return Ok(fd + 0);
+    }
+
+    [[gnu::noinline]] roc::result<int, int> read_header(int fd)
+    {
+        return open_file(fd).and_then([](int opened) { return roc::result<int, int>{Ok(opened * 2)}; });
+    }
+
+    [[gnu::noinline]] roc::result<std::string, int> parse(int fd)
+    {
+        auto header = read_header(fd);
+        if (header.is_err())
+            return roc::propagate(::roc::move(header));
+        return Ok(std::to_string(header.unwrap()));
+    }
+
+    [[gnu::noinline]] roc::result<std::string, long> load(int fd)
+    {
+        return parse(fd).map_err([](int e) { return static_cast<long>(e); });
+    }
+
+    [[gnu::noinline]] roc::result<int, int> bounce(int depth)
+    {
+        if (depth == 0)
+            return Err(1);
+        return bounce(depth - 1).and_then([](int v) { return roc::result<int, int>{Ok(v + 0)}; });
+    }
+}
+
+TEST_CASE("roc::error_trace - records where the error went") {
+    roc::error_trace::clear();
+
+    SUBCASE("one frame for the Err and one per propagation point") {
+        REQUIRE(load(-1).contains_err(9l));
+
+        const auto trace = roc::error_trace::current();
+        REQUIRE(trace.size() == 4);
+        REQUIRE(trace.dropped() == 0);
+        for (std::size_t i = 0; i < trace.size(); ++i)
+            REQUIRE(trace[i] != nullptr);
+
+        // distinct sites in distinct functions
+        REQUIRE(trace[0] != trace[1]);
+        REQUIRE(trace[1] != trace[2]);
+        REQUIRE(trace[2] != trace[3]);
+    }
+
+    SUBCASE("the success path doesn't touch the trace") {
+        REQUIRE(load(3).contains("6"));
+        REQUIRE(roc::error_trace::current().empty());
+    }
+
+    SUBCASE("a new Err starts a new trace") {
+        (void)load(-1);
+        REQUIRE(open_file(-1).is_err());
+        REQUIRE(roc::error_trace::current().size() == 1);
+    }
+
+    SUBCASE("an Err created while handling another keeps its own trace") {
+        auto outer = open_file(-1);
+        auto handled = outer.map_err([](int e) {
+            REQUIRE(open_file(-2).is_err());
+            return e + 1;
+        });
+        auto recovered = outer.or_else([](int) { return read_header(-3); });
+
+        REQUIRE(roc::error_trace::of(outer).size() == 3);
+        REQUIRE(roc::error_trace::of(handled).size() == 3);
+        REQUIRE(roc::error_trace::of(recovered).size() == 2);
+        REQUIRE(roc::error_trace::of(handled)[1] == roc::error_trace::of(outer)[1]);
+    }
+
+    SUBCASE("a callee failing during propagation doesn't wipe the trace") {
+        auto header = read_header(-1);
+        REQUIRE(load(-1).is_err());
+        auto passed = header.and_then([](int v) { return roc::result<int, int>{Ok(v + 0)}; });
+        REQUIRE(roc::error_trace::of(passed).size() == 3);
+        REQUIRE(roc::error_trace::current().size() == 4);
+    }
+
+    SUBCASE("results without an error have no trace") {
+        REQUIRE(roc::error_trace::of(open_file(1)).empty());
+    }
+
+    SUBCASE("deep propagation keeps the newest frames") {
+        REQUIRE(bounce(100).is_err());
+        const auto trace = roc::error_trace::current();
+        REQUIRE(trace.size() == roc::error_trace::CAPACITY);
+        REQUIRE(trace.dropped() == 101 - roc::error_trace::CAPACITY);
+    }
+
+    SUBCASE("printing symbolizes every frame") {
+        (void)load(-1);
+        std::ostringstream out;
+        out << roc::error_trace::current();
+
+        const std::string text = out.str();
+        REQUIRE(text.find("#0 0x") != std::string::npos);
+        REQUIRE(text.find("#3 0x") != std::string::npos);
+        REQUIRE(text.find("#4") == std::string::npos);
+    }
+}
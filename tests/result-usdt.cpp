@@ -0,0 +1,141 @@
+#define ROC_ENABLE_USDT
+#include <iostream>
+#include "doctest.h"
+
+#include <elf.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <roc/option.hpp>
+#include <roc/result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    struct probe
+    {
+        std::string     provider;
+        std::string     name;
+        std::string     arguments;
+        std::uint64_t   address;
+    };
+
+    struct elf_image
+    {
+        std::vector<char> bytes;
+
+        const Elf64_Ehdr& header() const { return *reinterpret_cast<const Elf64_Ehdr*>(bytes.data()); }
+        const Elf64_Shdr& section(std::size_t i) const {
+            return *reinterpret_cast<const Elf64_Shdr*>(bytes.data() + header().e_shoff + i * header().e_shentsize);
+        }
+        const char* section_name(const Elf64_Shdr& s) const {
+            return bytes.data() + section(header().e_shstrndx).sh_offset + s.sh_name;
+        }
+
+        const Elf64_Shdr* find(const char* name) const {
+            for (std::size_t i = 0; i < header().e_shnum; ++i)
+                if (std::strcmp(section_name(section(i)), name) == 0)
+                    return &section(i);
+            return nullptr;
+        }
+
+        // the file contents at a link time address
+        const unsigned char* at(std::uint64_t address) const {
+            for (std::size_t i = 0; i < header().e_shnum; ++i) {
+                const Elf64_Shdr& s = section(i);
+                if (s.sh_type == SHT_PROGBITS && address >= s.sh_addr && address < s.sh_addr + s.sh_size)
+                    return reinterpret_cast<const unsigned char*>(bytes.data() + s.sh_offset + (address - s.sh_addr));
+            }
+            return nullptr;
+        }
+    };
+
+    elf_image load_self()
+    {
+        std::ifstream file("/proc/self/exe", std::ios::binary);
+        return elf_image{std::vector<char>(std::istreambuf_iterator<char>(file), {})};
+    }
+
+    std::vector<probe> read_probes(const elf_image& image)
+    {
+        std::vector<probe> probes;
+        const Elf64_Shdr* notes = image.find(".note.stapsdt");
+        if (notes == nullptr)
+            return probes;
+
+        const char* cursor = image.bytes.data() + notes->sh_offset;
+        const char* end = cursor + notes->sh_size;
+        auto align4 = [](std::size_t n) { return (n + 3) & ~std::size_t{3}; };
+
+        while (cursor < end) {
+            const auto* note = reinterpret_cast<const Elf64_Nhdr*>(cursor);
+            const char* name = cursor + sizeof(Elf64_Nhdr);
+            const char* desc = name + align4(note->n_namesz);
+
+            if (note->n_type == 3 && std::strcmp(name, "stapsdt") == 0) {
+                probe p;
+                std::memcpy(&p.address, desc, sizeof p.address);
+                const char* strings = desc + 3 * sizeof(std::uint64_t);
+                p.provider = strings;
+                strings += p.provider.size() + 1;
+                p.name = strings;
+                strings += p.name.size() + 1;
+                p.arguments = strings;
+                probes.push_back(p);
+            }
+            cursor = desc + align4(note->n_descsz);
+        }
+        return probes;
+    }
+
+    // the probed paths, none of them fail here, but the inputs aren't known
+    // at compile time so the paths aren't folded away
+    [[gnu::noinline]] roc::result<int, int> make_error(int value)
+    {
+        return Err(value * 2);
+    }
+
+    [[gnu::noinline]] int use_probed_paths(const roc::result<int, int>& ok,
+                                           const roc::result<int, int>& failed,
+                                           const roc::option<int>& some)
+    {
+        return ok.unwrap() + failed.err_value() + some.unwrap();
+    }
+}
+
+TEST_CASE("roc::usdt - probe notes are in the binary") {
+    roc::result<int, int> ok = Ok(2);
+    REQUIRE(use_probed_paths(ok, make_error(2), roc::option<int>{2}) == 8);
+
+    const elf_image image = load_self();
+    const auto probes = read_probes(image);
+
+    for (const char* expected : {"err", "panic", "unwrap"}) {
+        CAPTURE(expected);
+        bool found = false;
+        for (const probe& p : probes) {
+            if (p.provider != "roc" || p.name != expected)
+                continue;
+            found = true;
+
+            // three arguments, two pointers and the line number
+            REQUIRE(p.arguments.rfind("8@", 0) == 0);
+            REQUIRE(p.arguments.find(" 8@") != std::string::npos);
+            REQUIRE(p.arguments.find("4@", p.arguments.rfind(' ')) != std::string::npos);
+
+            #if defined (__x86_64__)
+            // and the probe site is a single nop
+            const unsigned char* site = image.at(p.address);
+            REQUIRE(site != nullptr);
+            REQUIRE(*site == 0x90);
+            #endif
+        }
+        REQUIRE(found);
+    }
+
+    REQUIRE(image.find(".stapsdt.base") != nullptr);
+}
@@ -1,6 +1,9 @@
 #include <iostream>
 #include "doctest.h"
 
+#include <cstdint>
+#include <string>
+
 #include <roc/result.hpp>
 #include "test_types.hpp"
 
@@ -323,3 +326,199 @@ TEST_CASE("roc::result - references") {
         REQUIRE(ref_test.contains(22));
     }
 }
+
+TEST_CASE("roc::result - bool with a one-byte error fits in one byte") {
+    enum class parse_error : std::uint8_t { empty = 1, bad_digit = 2, last = 253 };
+    using flag_result = roc::result<bool, parse_error>;
+
+    static_assert(sizeof(flag_result) == 1);
+    static_assert(sizeof(roc::result<bool, std::uint8_t>) == 1);
+    static_assert(sizeof(roc::result<bool, int>) > 1);
+    static_assert(std::is_trivially_copyable<flag_result>::value);
+    static_assert(flag_result{Ok(true)}.unwrap());
+    static_assert(flag_result{Err(parse_error::empty)}.err_value() == parse_error::empty);
+
+    flag_result yes = Ok(true);
+    flag_result no = Ok(false);
+    flag_result failed = Err(parse_error::bad_digit);
+
+    REQUIRE(yes.is_ok());
+    REQUIRE(yes.contains(true));
+    REQUIRE(no.is_ok());
+    REQUIRE(no.contains(false));
+    REQUIRE(not no.unwrap());
+    REQUIRE(failed.is_err());
+    REQUIRE(failed.contains_err(parse_error::bad_digit));
+    REQUIRE(failed.unwrap_or(true));
+
+    SUBCASE("every error code round trips") {
+        for (unsigned code = 0; code <= flag_result::MAX_ERROR_CODE; ++code) {
+            roc::result<bool, std::uint8_t> res = Err(static_cast<std::uint8_t>(code));
+            REQUIRE(res.is_err());
+            REQUIRE(res.err_value() == code);
+        }
+        REQUIRE(flag_result{Err(parse_error::last)}.err_value() == parse_error::last);
+    }
+
+    SUBCASE("combinators") {
+        REQUIRE(yes.map([](bool v) { return v? 10 : 20; }).unwrap() == 10);
+        REQUIRE(failed.map([](bool v) { return v? 10 : 20; }).contains_err(parse_error::bad_digit));
+        REQUIRE(yes.and_then([](bool v) { return flag_result{Ok(not v)}; }).contains(false));
+        REQUIRE(failed.or_else([](parse_error) { return flag_result{Ok(false)}; }).contains(false));
+
+        auto widened = failed.map_err([](parse_error e) { return static_cast<int>(e) * 100; });
+        REQUIRE(widened.err_value() == 200);
+    }
+}
+
+TEST_CASE("roc::result - combinators") {
+    roc::result<int, int> ok = Ok(2);
+    roc::result<int, int> failed = Err(7);
+    auto halve = [](int v) { return v % 2? roc::result<int, int>{Err(v + 0)} : roc::result<int, int>{Ok(v / 2)}; };
+
+    REQUIRE(ok.and_then(halve).contains(1));
+    REQUIRE(failed.and_then(halve).contains_err(7));
+
+    REQUIRE(ok.map([](int v) { return v * 1.5; }).contains(3.0));
+    REQUIRE(failed.map([](int v) { return v * 1.5; }).contains_err(7));
+
+    auto described = failed.map_err([](int e) { return std::to_string(e); });
+    REQUIRE(described.err_value() == "7");
+    REQUIRE(ok.map_err([](int e) { return std::to_string(e); }).contains(2));
+
+    REQUIRE(failed.or_else([](int e) { return roc::result<int, int>{Ok(e * 10)}; }).contains(70));
+    REQUIRE(ok.or_else([](int e) { return roc::result<int, int>{Ok(e * 10)}; }).contains(2));
+
+    SUBCASE("propagate passes the error to another Ok type") {
+        auto as_text = [&](const roc::result<int, int>& res) -> roc::result<std::string, int> {
+            if (res.is_err())
+                return roc::propagate(res);
+            return Ok(std::to_string(res.unwrap()));
+        };
+        REQUIRE(as_text(failed).contains_err(7));
+        REQUIRE(as_text(ok).contains("2"));
+    }
+}
+
+TEST_CASE("roc::result - unobserved checking costs nothing when disabled") {
+    static_assert(std::is_empty<roc::detail::observation>::value);
+    static_assert(sizeof(roc::result<int, int>) == sizeof(roc::detail::result_storage<int, int>));
+    static_assert(sizeof(roc::result<void, int>) == sizeof(roc::detail::result_storage<void, int>));
+    static_assert(sizeof(roc::result<bool, std::uint8_t>) == 1);
+    static_assert(std::is_trivially_copyable<roc::result<int, int>>::value);
+    static_assert(std::is_trivially_destructible<roc::result<void, int>>::value);
+
+    REQUIRE(sizeof(roc::result<double, int>) == 2 * sizeof(double));
+}
+
+TEST_CASE("roc::result - operation counts") {
+    struct value_tag;
+    struct error_tag;
+    using value = counting_type<value_tag>;
+    using error = counting_type<error_tag>;
+    using counted_result = roc::result<value, error>;
+
+    value::reset();
+    error::reset();
+
+    // Ok / Err hold the argument until the result is built from them, so
+    // building a result from a temporary takes two moves
+    SUBCASE("constructing") {
+        {
+            value v{1};
+            counted_result res = Ok(roc::move(v));
+            REQUIRE_OPS(value, copies == 0, moves == 2, live == 2);
+            REQUIRE(res.unwrap().value == 1);
+            REQUIRE(v.value == value::MOVED_FROM);
+        }
+        REQUIRE_OPS(value, live == 0);
+
+        {
+            counted_result res = Err(error{2});
+            REQUIRE_OPS(error, copies == 0, moves == 2, live == 1);
+            REQUIRE(res.err_value().value == 2);
+        }
+        REQUIRE_OPS(error, live == 0);
+        REQUIRE_OPS(value, moves == 2);
+    }
+
+    SUBCASE("assigning") {
+        counted_result res = Ok(value{1});
+        value::reset();
+
+        res = Ok(value{2});
+        REQUIRE_OPS(value, copies == 0, moves == 2, destroys == 3, copy_assigns == 0, move_assigns == 0);
+
+        res = Err(error{3});
+        REQUIRE_OPS(value, destroys == 4, live == -1);
+        REQUIRE_OPS(error, copies == 0, moves == 2, destroys == 2, live == 1);
+
+        res = Ok(value{4});
+        REQUIRE_OPS(error, destroys == 3, live == 0);
+        REQUIRE(res.contains(value{4}));
+    }
+
+    SUBCASE("unwrapping") {
+        counted_result res = Ok(value{1});
+        value::reset();
+
+        REQUIRE(res.unwrap().value == 1);
+        REQUIRE_OPS(value, copies == 0, moves == 0);
+
+        REQUIRE(res.unwrap_or(value{5}).value == 1);
+        REQUIRE_OPS(value, copies == 1, moves == 0, live == 0);
+
+        value taken = roc::move(res).unwrap();
+        REQUIRE(taken.value == 1);
+        REQUIRE_OPS(value, copies == 1, moves == 1);
+
+        counted_result failed = Err(error{2});
+        value::reset();
+        REQUIRE(failed.unwrap_or(value{5}).value == 5);
+        REQUIRE_OPS(value, copies == 0, moves == 1, live == 0);
+    }
+
+    SUBCASE("combinators on Ok") {
+        counted_result res = Ok(value{1});
+        value::reset();
+
+        REQUIRE(res.map([](const value& v) { return v.value + 1; }).contains(2));
+        REQUIRE(res.and_then([](const value& v) { return roc::result<int, error>{Ok(v.value + 0)}; }).contains(1));
+        REQUIRE_OPS(value, copies == 0, moves == 0, live == 0);
+
+        auto mapped = res.map([](const value& v) { return value{v.value + 1}; });
+        REQUIRE_OPS(value, copies == 0, moves == 2, live == 1);
+
+        // map_err keeps the value, which it has to copy out of an lvalue
+        value::reset();
+        auto kept = res.map_err([](const error& e) { return e.value; });
+        REQUIRE_OPS(value, copies == 1, moves == 1, live == 1);
+        REQUIRE_OPS(error, copies == 0, moves == 0);
+        REQUIRE(mapped.is_ok());
+        REQUIRE(kept.is_ok());
+    }
+
+    SUBCASE("combinators on Err") {
+        counted_result res = Err(error{1});
+        error::reset();
+
+        auto mapped = res.map([](const value& v) { return v.value; });
+        REQUIRE_OPS(error, copies == 1, moves == 1, live == 1);
+
+        auto chained = res.and_then([](const value& v) { return roc::result<int, error>{Ok(v.value + 0)}; });
+        REQUIRE_OPS(error, copies == 2, moves == 2, live == 2);
+
+        error::reset();
+        auto widened = res.map_err([](const error& e) { return e.value * 10; });
+        REQUIRE(widened.contains_err(10));
+        REQUIRE_OPS(error, copies == 0, moves == 0);
+
+        auto replaced = res.map_err([](const error& e) { return error{e.value + 1}; });
+        REQUIRE_OPS(error, copies == 0, moves == 2, live == 1);
+        REQUIRE_OPS(value, copies == 0, moves == 0, default_constructs == 0);
+
+        REQUIRE(mapped.is_err());
+        REQUIRE(chained.is_err());
+        REQUIRE(replaced.err_value().value == 2);
+    }
+}
@@ -0,0 +1,30 @@
+#define ROC_ENABLE_ERROR_TRACE
+#include <iostream>
+#include "doctest.h"
+
+#include <cerrno>
+
+#include <roc/signed_result.hpp>
+
+using namespace roc::import;
+
+TEST_CASE("roc::signed_result - combinators with error traces on") {
+    roc::error_trace::clear();
+
+    const roc::signed_result<int> ok = Ok(4);
+    const roc::signed_result<int> err = roc::signed_result<int>::from_raw(-EBADF);
+    auto twice = [](int v) { return roc::signed_result<int>{Ok(v * 2)}; };
+
+    REQUIRE(ok.and_then(twice).contains(8));
+    REQUIRE(err.and_then(twice).contains_err(EBADF));
+    REQUIRE(err.map([](int v) { return v + 1; }).contains_err(EBADF));
+    REQUIRE(err.map_err([](int e) { return e + 1; }).contains_err(EBADF + 1));
+    REQUIRE(err.or_else([](int) { return roc::signed_result<int>{Ok(0)}; }).contains(0));
+
+    SUBCASE("the word has no trace, so a traced error is left alone") {
+        roc::result<int, int> traced = Err(1);
+        REQUIRE(roc::error_trace::of(traced).size() == 1);
+        REQUIRE(err.and_then(twice).is_err());
+        REQUIRE(roc::error_trace::of(traced).size() == 1);
+    }
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <roc/signed_result.hpp>
+
+using namespace roc::import;
+
+namespace {
+    static_assert(sizeof(roc::signed_result<ssize_t>) == sizeof(ssize_t));
+    static_assert(sizeof(roc::signed_result<int, std::errc>) == sizeof(int));
+    static_assert(std::is_trivially_copyable<roc::signed_result<long>>::value);
+
+    constexpr roc::signed_result<int> constant_ok = Ok(3);
+    constexpr roc::signed_result<int> constant_err = Err(EINVAL);
+    static_assert(constant_ok.is_ok() && constant_ok.unwrap() == 3);
+    static_assert(constant_err.is_err() && constant_err.err_value() == EINVAL);
+    static_assert(constant_err.raw_value() == -EINVAL);
+
+    roc::signed_result<ssize_t> checked_read(int fd, void* buffer, std::size_t size)
+    {
+        return roc::signed_result<ssize_t>::from_errno(::read(fd, buffer, size));
+    }
+}
+
+TEST_CASE("roc::signed_result - construction") {
+    roc::signed_result<long> ok = Ok(42);
+    roc::signed_result<long> zero = Ok(0);
+    roc::signed_result<long> err = Err(ENOENT);
+
+    REQUIRE(ok.is_ok());
+    REQUIRE(ok.unwrap() == 42);
+    REQUIRE(ok.contains(42));
+    REQUIRE(zero.is_ok());
+    REQUIRE(err.is_err());
+    REQUIRE(err.err_value() == ENOENT);
+    REQUIRE(err.contains_err(ENOENT));
+    REQUIRE(err.unwrap_or(-7) == -7);
+
+    SUBCASE("raw values in the kernel convention") {
+        REQUIRE(roc::signed_result<long>::from_raw(5).unwrap() == 5);
+        REQUIRE(roc::signed_result<long>::from_raw(-EAGAIN).err_value() == EAGAIN);
+    }
+
+    SUBCASE("enum errors") {
+        roc::signed_result<int, std::errc> denied = Err(std::errc::permission_denied);
+        REQUIRE(denied.err_value() == std::errc::permission_denied);
+        REQUIRE(denied.raw_value() == -EACCES);
+    }
+
+    SUBCASE("converts to result") {
+        roc::result<long, int> as_result = err;
+        REQUIRE(as_result.is_err());
+        REQUIRE(as_result.err_value() == ENOENT);
+
+        roc::result<long, int> ok_result = ok;
+        REQUIRE(ok_result.unwrap() == 42);
+    }
+}
+
+TEST_CASE("roc::signed_result - combinators") {
+    roc::signed_result<long> ok = Ok(10);
+    roc::signed_result<long> err = Err(EIO);
+
+    SUBCASE("map") {
+        auto doubled = ok.map([](long v) { return v * 2; });
+        static_assert(std::is_same<decltype(doubled), roc::signed_result<long>>::value);
+        REQUIRE(doubled.unwrap() == 20);
+        REQUIRE(err.map([](long v) { return v * 2; }).err_value() == EIO);
+
+        auto as_double = ok.map([](long v) { return v / 4.0; });
+        static_assert(std::is_same<decltype(as_double), roc::result<double, int>>::value);
+        REQUIRE(as_double.unwrap() == 2.5);
+    }
+
+    SUBCASE("and_then / or_else / map_err") {
+        auto halve = [](long v) -> roc::signed_result<long> {
+            if (v % 2) return Err(EDOM);
+            return Ok(v / 2);
+        };
+        REQUIRE(ok.and_then(halve).unwrap() == 5);
+        REQUIRE(ok.and_then(halve).and_then(halve).err_value() == EDOM);
+        REQUIRE(err.and_then(halve).err_value() == EIO);
+
+        auto recover = [](int) -> roc::signed_result<long> { return Ok(0); };
+        REQUIRE(err.or_else(recover).unwrap() == 0);
+        REQUIRE(ok.or_else(recover).unwrap() == 10);
+
+        auto described = err.map_err([](int code) { return code == EIO? 'i' : '?'; });
+        REQUIRE(described.err_value() == 'i');
+    }
+}
+
+TEST_CASE("roc::signed_result - system calls") {
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    REQUIRE(::write(fds[1], "abc", 3) == 3);
+
+    char buffer[8];
+    auto read = checked_read(fds[0], buffer, sizeof buffer);
+    REQUIRE(read.unwrap() == 3);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    auto bad = checked_read(fds[0], buffer, sizeof buffer);
+    REQUIRE(bad.err_value() == EBADF);
+
+    auto raw = roc::signed_result<long>::from_raw(::syscall(SYS_close, -1) == -1? -errno : 0);
+    REQUIRE(raw.err_value() == EBADF);
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <stdexcept>
+#include <string>
+
+#include <roc/slot_map.hpp>
+
+TEST_CASE("roc::slot_map - insert / get / erase") {
+    roc::slot_map<std::string> map;
+    REQUIRE(map.empty());
+
+    auto a = map.insert("a");
+    auto b = map.insert("b");
+    auto c = map.emplace(3, 'c');
+    REQUIRE(map.size() == 3);
+
+    REQUIRE(map.get(a).unwrap() == "a");
+    REQUIRE(map.get(b).unwrap() == "b");
+    REQUIRE(map.get(c).unwrap() == "ccc");
+
+    SUBCASE("get returns a reference into the map") {
+        map.get(b).unwrap() += "!";
+        REQUIRE(map.get(b).unwrap() == "b!");
+
+        const auto& const_map = map;
+        REQUIRE(const_map.get(b).unwrap() == "b!");
+    }
+
+    SUBCASE("erase moves the value out and keeps other handles valid") {
+        auto erased = map.erase(a);
+        REQUIRE(erased.is_some());
+        REQUIRE(erased.unwrap() == "a");
+        REQUIRE(map.size() == 2);
+
+        REQUIRE(map.get(a).is_none());
+        REQUIRE(map.get(b).unwrap() == "b");
+        REQUIRE(map.get(c).unwrap() == "ccc");
+        REQUIRE(map.erase(a).is_none());
+    }
+
+    SUBCASE("stale handles don't alias a reused slot") {
+        (void)map.erase(b);
+        auto d = map.insert("d");
+        REQUIRE(d.index == b.index);
+        REQUIRE(d.generation != b.generation);
+        REQUIRE(map.get(b).is_none());
+        REQUIRE(map.get(d).unwrap() == "d");
+    }
+
+    SUBCASE("default and out of range handles are invalid") {
+        REQUIRE(not map.contains(roc::slot_handle{}));
+        REQUIRE(map.get(roc::slot_handle{1000, 1}).is_none());
+        REQUIRE(map.get(roc::slot_handle{a.index, a.generation + 1}).is_none());
+    }
+
+    SUBCASE("clear invalidates every handle") {
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(not map.contains(a));
+        REQUIRE(not map.contains(b));
+        REQUIRE(not map.contains(c));
+    }
+}
+
+namespace {
+    struct fragile
+    {
+        explicit fragile(int v) : value(v) {
+            if (v < 0)
+                throw std::invalid_argument("negative");
+        }
+
+        int value;
+    };
+}
+
+TEST_CASE("roc::slot_map - a throwing constructor leaves the map unchanged") {
+    roc::slot_map<fragile> map;
+    const auto first = map.emplace(1);
+    const auto erased = map.emplace(2);
+    REQUIRE(map.erase(erased).is_some());
+
+    // once with a free slot to reuse, once with a fresh one
+    for (int i = 0; i < 2; ++i) {
+        const std::size_t size = map.size();
+        REQUIRE_THROWS_AS(map.emplace(-1), std::invalid_argument);
+        REQUIRE(map.size() == size);
+        REQUIRE(map.get(first).unwrap().value == 1);
+        REQUIRE(not map.contains(erased));
+
+        const auto next = map.emplace(3 + i);
+        REQUIRE(map.size() == size + 1);
+        REQUIRE(map.get(next).unwrap().value == 3 + i);
+        REQUIRE(map.handle_at(size) == next);
+        REQUIRE(next.generation % 2 == 1);
+        if (i == 0) {
+            REQUIRE(next.index == erased.index);
+            REQUIRE(next.generation == erased.generation + 2);
+        }
+    }
+}
+
+TEST_CASE("roc::slot_map - dense iteration") {
+    roc::slot_map<int> map;
+    roc::slot_handle handles[10];
+    for (int i = 0; i < 10; ++i)
+        handles[i] = map.insert(i);
+
+    for (int i = 0; i < 10; i += 2)
+        (void)map.erase(handles[i]);
+
+    int sum = 0;
+    for (int v : map)
+        sum += v;
+    REQUIRE(sum == 1 + 3 + 5 + 7 + 9);
+
+    for (std::size_t i = 0; i < map.size(); ++i)
+        REQUIRE(map.get(map.handle_at(i)).contains(map.data()[i]));
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include "doctest.h"
+
+#include <atomic>
+#include <string>
+
+#include <roc/task_graph.hpp>
+
+using namespace roc::import;
+
+namespace {
+    enum class task_error { failed, other };
+}
+
+TEST_CASE("roc::task_graph - values flow along the edges") {
+    SUBCASE("chain") {
+        roc::task_graph<task_error> graph;
+
+        auto a = graph.emplace([]() -> roc::result<int, task_error> { return Ok(20); });
+        auto b = graph.emplace([](int&& x) -> roc::result<int, task_error> { return Ok(x + 1); }, a);
+        auto c = graph.emplace([](int&& x) -> roc::result<int, task_error> { return Ok(x * 2); }, b);
+
+        REQUIRE(graph.run(2).is_ok());
+        REQUIRE(graph.take(c).contains(42));
+    }
+
+    SUBCASE("diamond with moved nontrivial values") {
+        roc::task_graph<task_error> graph;
+
+        auto left = graph.emplace([]() -> roc::result<std::string, task_error> { return Ok(std::string("left")); });
+        auto right = graph.emplace([]() -> roc::result<std::string, task_error> { return Ok(std::string("right")); });
+        auto join = graph.emplace([](std::string&& l, std::string&& r) -> roc::result<std::string, task_error> {
+            return Ok(l + "+" + r);
+        }, left, right);
+
+        REQUIRE(graph.run(4).is_ok());
+        REQUIRE(graph.take(join).unwrap() == "left+right");
+
+        // values passed along an edge are moved out of the producer
+        REQUIRE(graph.take(left).is_none());
+        REQUIRE(graph.take(right).is_none());
+    }
+
+    SUBCASE("ordering-only edges") {
+        roc::task_graph<task_error> graph;
+        std::atomic<int> step {0};
+        int seen = -1;
+
+        auto first = graph.emplace([&]() -> roc::result<void, task_error> { step = 1; return Ok(); });
+        auto second = graph.emplace([&]() -> roc::result<void, task_error> { seen = step; return Ok(); });
+        graph.precede(first, second);
+
+        REQUIRE(graph.run(4).is_ok());
+        REQUIRE(seen == 1);
+    }
+}
+
+TEST_CASE("roc::task_graph - errors cancel dependents") {
+    roc::task_graph<task_error> graph;
+    std::atomic<int> executed {0};
+
+    auto ok_root = graph.emplace([&]() -> roc::result<int, task_error> { executed++; return Ok(1); });
+    auto bad_root = graph.emplace([&]() -> roc::result<int, task_error> { executed++; return Err(task_error::failed); });
+
+    auto child = graph.emplace([&](int&& a, int&& b) -> roc::result<int, task_error> { executed++; return Ok(a + b); },
+                               ok_root, bad_root);
+    auto grandchild = graph.emplace([&](int&& a) -> roc::result<int, task_error> { executed++; return Ok(a); }, child);
+    auto independent = graph.emplace([&]() -> roc::result<int, task_error> { executed++; return Ok(7); });
+
+    auto res = graph.run(3);
+    REQUIRE(res.is_err());
+    REQUIRE(res.contains_err(task_error::failed));
+
+    REQUIRE(executed == 3);
+    REQUIRE(graph.take(child).is_none());
+    REQUIRE(graph.take(grandchild).is_none());
+    REQUIRE(graph.take(independent).contains(7));
+}
+
+TEST_CASE("roc::task_graph - wide graph") {
+    constexpr int width = 10000;
+
+    roc::task_graph<task_error> graph;
+    std::atomic<long> sum {0};
+
+    auto root = graph.emplace([]() -> roc::result<void, task_error> { return Ok(); });
+    for (int i = 0; i < width; ++i) {
+        auto leaf = graph.emplace([&sum, i]() -> roc::result<void, task_error> {
+            sum.fetch_add(i, std::memory_order_relaxed);
+            return Ok();
+        });
+        graph.precede(root, leaf);
+    }
+
+    REQUIRE(graph.size() == width + 1);
+    REQUIRE(graph.run().is_ok());
+    REQUIRE(sum == long(width) * (width - 1) / 2);
+
+    // graphs can be run again
+    sum = 0;
+    REQUIRE(graph.run(1).is_ok());
+    REQUIRE(sum == long(width) * (width - 1) / 2);
+}
+
+TEST_CASE("roc::task_graph - workers are kept between runs") {
+    roc::task_graph<task_error> graph;
+    std::atomic<int> runs {0};
+
+    // a long chain, so the other workers find nothing to steal and sleep
+    auto previous = graph.emplace([]() -> roc::result<int, task_error> { return Ok(0); });
+    for (int i = 0; i < 200; ++i)
+        previous = graph.emplace([](int v) -> roc::result<int, task_error> { return Ok(v + 1); }, previous);
+    graph.emplace([&runs](int v) -> roc::result<void, task_error> {
+        runs.fetch_add(v == 200, std::memory_order_relaxed);
+        return Ok();
+    }, previous);
+
+    for (int i = 0; i < 50; ++i)
+        REQUIRE(graph.run(4).is_ok());
+    REQUIRE(graph.run(2).is_ok());
+    REQUIRE(graph.run(4).is_ok());
+    REQUIRE(runs == 52);
+}
@@ -1,6 +1,9 @@
 #ifndef ROC_TEST_TYPES_HPP
 #define ROC_TEST_TYPES_HPP
 
+#include <initializer_list>
+#include <ostream>
+
 struct trivial_type {
     trivial_type() = default;
     trivial_type(const trivial_type&) = default;
@@ -28,4 +31,76 @@ struct nontrivial_type {
     ~nontrivial_type() {};
 };
 
+// Special member calls of one counting_type, give each test its own tag so
+// the counts don't leak between tests
+struct op_counts {
+    int default_constructs = 0;
+    int value_constructs = 0;
+    int copies = 0;
+    int moves = 0;
+    int copy_assigns = 0;
+    int move_assigns = 0;
+    int destroys = 0;
+
+    int constructs() const { return default_constructs + value_constructs + copies + moves; }
+    int live() const { return constructs() - destroys; }
+
+    friend std::ostream& operator<<(std::ostream& stream, const op_counts& ops) {
+        return stream << "default " << ops.default_constructs << ", from value " << ops.value_constructs
+                      << ", copies " << ops.copies << ", moves " << ops.moves
+                      << ", copy assigns " << ops.copy_assigns << ", move assigns " << ops.move_assigns
+                      << ", destroys " << ops.destroys;
+    }
+};
+
+template <typename Tag>
+struct counting_type {
+    static inline op_counts ops;
+    static void reset() { ops = op_counts{}; }
+
+    // moved-from objects hold this
+    constexpr static int MOVED_FROM = -1;
+
+    counting_type() noexcept { ops.default_constructs++; }
+    explicit counting_type(int v) noexcept : value(v) { ops.value_constructs++; }
+    counting_type(const counting_type& other) noexcept : value(other.value) { ops.copies++; }
+    counting_type(counting_type&& other) noexcept : value(other.value) { other.value = MOVED_FROM; ops.moves++; }
+    counting_type& operator=(const counting_type& other) noexcept { value = other.value; ops.copy_assigns++; return *this; }
+    counting_type& operator=(counting_type&& other) noexcept {
+        value = other.value;
+        other.value = MOVED_FROM;
+        ops.move_assigns++;
+        return *this;
+    }
+    ~counting_type() { ops.destroys++; }
+
+    bool operator==(const counting_type& other) const noexcept { return value == other.value; }
+
+    int value = 0;
+};
+
+inline bool all_of(std::initializer_list<bool> conditions) {
+    for (bool condition : conditions)
+        if (not condition)
+            return false;
+    return true;
+}
+
+// REQUIRE_OPS(counted, copies == 0, moves <= 1) checks the counts of
+// counting_type counted since its last reset, and prints them on failure
+#define REQUIRE_OPS(Counted, ...)                                                                   \
+    do {                                                                                            \
+        const op_counts roc_ops = Counted::ops;                                                     \
+        [[maybe_unused]] const int default_constructs = roc_ops.default_constructs;                \
+        [[maybe_unused]] const int value_constructs = roc_ops.value_constructs;                    \
+        [[maybe_unused]] const int copies = roc_ops.copies;                                         \
+        [[maybe_unused]] const int moves = roc_ops.moves;                                           \
+        [[maybe_unused]] const int copy_assigns = roc_ops.copy_assigns;                             \
+        [[maybe_unused]] const int move_assigns = roc_ops.move_assigns;                             \
+        [[maybe_unused]] const int destroys = roc_ops.destroys;                                     \
+        [[maybe_unused]] const int live = roc_ops.live();                                           \
+        INFO(#Counted ": " << roc_ops);                                                             \
+        REQUIRE(all_of({__VA_ARGS__}));                                                             \
+    } while (0)
+
 #endif